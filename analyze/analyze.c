@@ -0,0 +1,272 @@
+/*
+ * File: analyze.c
+ * Description: Offline analysis of binary k_log trace files
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "log/kernel_trace.h"
+#include "log/trace_file.h"
+#include "analyze.h"
+#include "export.h"
+
+/*
+ * Running extremes and mean of a duration in ns.
+ */
+struct analyze_stat
+{
+	long long st_n;
+	long long st_min;
+	long long st_max;
+	double st_sum;
+};
+
+struct analyze_task
+{
+	struct k_log_file_task at_param;
+	int at_jobs; /* Jobs started */
+	int at_unreleased; /* Jobs started with no release logged */
+	bool at_open; /* A job started and hasn't completed */
+	bool at_pending; /* A job was released and hasn't started */
+	bool at_late; /* The latest job completed past the next one's release */
+	long long at_release; /* Release of the latest job started */
+	long long at_next; /* Release of the pending job */
+	struct analyze_stat at_response; /* Release to completion */
+	struct analyze_stat at_latency; /* Release to start */
+	int at_preemptions;
+	int at_misses;
+};
+
+/*
+ * A scheduler phase, bracketed by the begin and end of its event id.
+ */
+struct analyze_phase
+{
+	int ph_id;
+	const char* ph_name;
+	bool ph_open;
+	long long ph_begin;
+	struct analyze_stat ph_cost;
+};
+
+static void analyze_stat_add(struct analyze_stat* stat, long long ns)
+{
+	if (!stat->st_n || ns < stat->st_min) stat->st_min = ns;
+	if (!stat->st_n || ns > stat->st_max) stat->st_max = ns;
+	stat->st_sum += ns;
+	stat->st_n++;
+}
+
+static void analyze_stat_print(const char* name, struct analyze_stat* stat)
+{
+	if (!stat->st_n) {
+		printf("\t%s us: none\n", name);
+		return;
+	}
+	printf("\t%s us: min %.1f avg %.1f max %.1f\n", name,
+			stat->st_min / 1000.0, stat->st_sum / stat->st_n / 1000.0,
+			stat->st_max / 1000.0);
+}
+
+static struct analyze_task* analyze_find(struct analyze_task* tasks, int n,
+		int id)
+{
+	int i;
+	for (i = 0; i < n; i++) {
+		if (tasks[i].at_param.ft_id == id) return &tasks[i];
+	}
+	return NULL;
+}
+
+/*
+ * Note the release of a task's next job, logged at ns. A job whose
+ * predecessor overran its release was due one period after the
+ * predecessor's, however late the scheduler got to it.
+ */
+static void analyze_release(struct analyze_task* task, long long ns,
+		long long q)
+{
+	long long due = task->at_release + task->at_param.ft_p * q;
+	task->at_next = task->at_late ? due : ns;
+	task->at_pending = true;
+}
+
+int analyze_trace(const char* path)
+{
+	struct k_log_file* file = k_log_file_open(path);
+	if (!file) {
+		fprintf(stderr, "analyze: %s is not a readable trace file\n", path);
+		return -1;
+	}
+	const struct k_log_file_header* header = k_log_file_header(file);
+	if (header->fh_dropped) {
+		fprintf(stderr, "analyze: WARNING: %s lost %llu events before they "
+				"reached the file; its counts are incomplete\n", path,
+				(unsigned long long) header->fh_dropped);
+	}
+	int n = header->fh_ntasks;
+	long long q = header->fh_quantum_ns;
+	int cores = header->fh_cores > 0 ? header->fh_cores : 1;
+
+	struct analyze_task* tasks = calloc(n ? n : 1, sizeof(*tasks));
+	int i;
+	for (i = 0; i < n; i++) {
+		tasks[i].at_param = k_log_file_tasks(file)[i];
+	}
+
+	struct analyze_phase phases[] = {
+		{ LOG_K_ALGO, "schedule" },
+		{ LOG_K_RELEASE, "release" },
+		{ LOG_K_RECALC, "recalc" },
+		{ LOG_K_FIXT, "fixture" },
+	};
+	int nphases = sizeof(phases) / sizeof(phases[0]);
+
+	/*
+	 * Jobs which started but haven't completed, latest on top. Under a
+	 * job-level fixed priority algo on one core, a job only starts by
+	 * preempting the latest job still open, so that's the one charged.
+	 * With several cores, it's a guess as to which core was taken.
+	 */
+	struct analyze_task** open = calloc(n ? n : 1, sizeof(*open));
+	int nopen = 0;
+
+	long long t0 = -1; /* Start of the run: every task's first release */
+	long long ns = 0;
+	long long events = 0, unknown = 0;
+	int event, kind;
+	while (k_log_file_next(file, &ns, &event, &kind)) {
+		events++;
+
+		struct analyze_phase* phase = NULL;
+		for (i = 0; i < nphases; i++) {
+			if (phases[i].ph_id == event) phase = &phases[i];
+		}
+		if (phase) {
+			if (kind == LOG_K_BEG) {
+				if (t0 < 0 && event == LOG_K_ALGO) t0 = ns;
+				phase->ph_begin = ns;
+				phase->ph_open = true;
+			} else if (phase->ph_open) {
+				analyze_stat_add(&phase->ph_cost, ns - phase->ph_begin);
+				phase->ph_open = false;
+			}
+			continue;
+		}
+
+		struct analyze_task* task;
+		if (event >= LOG_K_ARRIVAL) {
+			task = analyze_find(tasks, n, event - LOG_K_ARRIVAL);
+			if (task) analyze_release(task, ns, q);
+			else unknown++;
+			continue;
+		}
+
+		task = analyze_find(tasks, n, event);
+		if (!task) {
+			unknown++;
+			continue;
+		}
+		if (t0 < 0) t0 = ns;
+
+		struct k_log_file_task* p = &task->at_param;
+		if (kind == LOG_K_BEG && !task->at_open) {
+			if (task->at_pending) {
+				/* Jobs released while the run was set up count from t0 */
+				task->at_release = task->at_next > t0 ? task->at_next : t0;
+			} else {
+				/* The release was lost: assume the job came a period on */
+				task->at_release = task->at_jobs
+						? task->at_release + p->ft_p * q : t0;
+				task->at_unreleased++;
+			}
+			task->at_pending = false;
+			task->at_jobs++;
+			task->at_open = true;
+			analyze_stat_add(&task->at_latency, ns - task->at_release);
+
+			if (nopen >= cores) open[nopen - 1]->at_preemptions++;
+			open[nopen++] = task;
+		} else if (kind == LOG_K_END && task->at_open) {
+			analyze_stat_add(&task->at_response, ns - task->at_release);
+			if (ns > task->at_release + p->ft_d * q) task->at_misses++;
+			task->at_late = ns > task->at_release + p->ft_p * q;
+			task->at_open = false;
+
+			for (i = 0; open[i] != task; i++);
+			for (; i < nopen - 1; i++) open[i] = open[i + 1];
+			nopen--;
+		}
+	}
+
+	/* Jobs cut off by the end of the run miss if their deadline passed */
+	for (i = 0; i < n; i++) {
+		struct analyze_task* task = &tasks[i];
+		long long d = task->at_param.ft_d * q;
+		if (task->at_open && ns > task->at_release + d) {
+			task->at_misses++;
+		}
+		if (task->at_pending && ns > task->at_next + d) {
+			task->at_misses++;
+		}
+	}
+
+	printf(" [ TRACE %s ] %s on set %d, %d cores, %d tasks, %lld events, "
+			"%s clock\n", path, header->fh_algo, header->fh_set, cores, n,
+			events, header->fh_virtual ? "virtual" : "monotonic");
+	if (header->fh_dropped) {
+		printf(" [ INCOMPLETE: %llu EVENTS DROPPED ]\n",
+				(unsigned long long) header->fh_dropped);
+	}
+	for (i = 0; i < n; i++) {
+		struct analyze_task* task = &tasks[i];
+		struct analyze_stat* latency = &task->at_latency;
+		printf(" [ TASK %d ] jobs %d misses %d preemptions %d jitter us %.1f\n",
+				task->at_param.ft_id, task->at_jobs, task->at_misses,
+				task->at_preemptions,
+				(latency->st_max - latency->st_min) / 1000.0);
+		analyze_stat_print("response", &task->at_response);
+		analyze_stat_print("release to start", latency);
+		if (task->at_unreleased) {
+			printf("\t%d jobs with no release logged\n", task->at_unreleased);
+		}
+	}
+	for (i = 0; i < nphases; i++) {
+		struct analyze_phase* phase = &phases[i];
+		if (!phase->ph_cost.st_n) continue;
+		printf(" [ PHASE %s ] count %lld total us %.1f\n", phase->ph_name,
+				phase->ph_cost.st_n, phase->ph_cost.st_sum / 1000.0);
+		analyze_stat_print("cost", &phase->ph_cost);
+	}
+	if (unknown) {
+		printf(" [ %lld events of unknown ids ]\n", unknown);
+	}
+
+	free(open);
+	free(tasks);
+	k_log_file_close(file);
+	return 0;
+}
+
+#ifdef ANALYZE_MAIN
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <trace>... | -chrome <trace> <json>\n",
+				argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (argc == 4 && strcmp(argv[1], "-chrome") == 0) {
+		return export_chrome(argv[2], argv[3]) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	int status = EXIT_SUCCESS;
+	int i;
+	for (i = 1; i < argc; i++) {
+		if (analyze_trace(argv[i])) status = EXIT_FAILURE;
+	}
+	return status;
+}
+#endif
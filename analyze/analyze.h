@@ -0,0 +1,22 @@
+/*
+ * File: analyze.h
+ * Description: Offline analysis of binary k_log trace files
+ */
+
+#ifndef ANALYZE_H_
+#define ANALYZE_H_
+
+/*
+ * Read a trace file written with FIXT_TRACE_FILES and print, for each task,
+ * its jobs' response times, release jitter, preemptions and deadline misses,
+ * and, for each scheduler phase, its overhead. The trace is streamed, so
+ * its length is not limited by memory. Returns 0 on success, or -1 if the
+ * file can't be read.
+ *
+ * Built with ANALYZE_MAIN defined, analyze.c, export.c and log/trace_file.c
+ * make up a standalone analyzer and exporter, for hosts without the rest of
+ * the project.
+ */
+int analyze_trace(const char* path);
+
+#endif
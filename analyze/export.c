@@ -0,0 +1,259 @@
+/*
+ * File: export.c
+ * Description: Export of binary k_log trace files for trace viewers
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "log/kernel_trace.h"
+#include "log/trace_file.h"
+#include "export.h"
+
+#define EXPORT_PID 1
+#define EXPORT_SCHED_TID LOG_K_ALGO /* Task ids stay below it */
+
+struct export_task
+{
+	struct k_log_file_task et_param;
+	int et_jobs; /* Jobs started */
+	bool et_open; /* A job started and hasn't completed */
+	bool et_pending; /* A job was released and hasn't started */
+	bool et_late; /* The latest job completed past the next one's release */
+	long long et_release; /* Release of the latest job started */
+	long long et_next; /* Release of the pending job */
+};
+
+/*
+ * JSON is written one event per line as the trace is read, never held.
+ */
+struct export_out
+{
+	FILE* eo_file;
+	bool eo_first; /* No event written yet, so no comma needed */
+	long long eo_base; /* Time of the first event, as ts 0 */
+};
+
+static void export_begin(struct export_out* out)
+{
+	fprintf(out->eo_file, out->eo_first ? "\n" : ",\n");
+	out->eo_first = false;
+}
+
+static void export_ts(struct export_out* out, long long ns)
+{
+	/* Chrome wants microseconds; keep the ns as decimals */
+	long long rel = ns - out->eo_base;
+	if (rel < 0) rel = 0;
+	fprintf(out->eo_file, "\"ts\":%lld.%03lld", rel / 1000, rel % 1000);
+}
+
+static void export_slice(struct export_out* out, const char* name, char ph,
+		long long ns, int tid)
+{
+	export_begin(out);
+	fprintf(out->eo_file, "{\"name\":\"%s\",\"ph\":\"%c\",", name, ph);
+	export_ts(out, ns);
+	fprintf(out->eo_file, ",\"pid\":%d,\"tid\":%d}", EXPORT_PID, tid);
+}
+
+static void export_instant(struct export_out* out, const char* name,
+		long long ns, int tid)
+{
+	export_begin(out);
+	fprintf(out->eo_file, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",", name);
+	export_ts(out, ns);
+	fprintf(out->eo_file, ",\"pid\":%d,\"tid\":%d}", EXPORT_PID, tid);
+}
+
+static void export_counter(struct export_out* out, const char* name,
+		long long ns, long long value)
+{
+	export_begin(out);
+	fprintf(out->eo_file, "{\"name\":\"%s\",\"ph\":\"C\",", name);
+	export_ts(out, ns);
+	fprintf(out->eo_file, ",\"pid\":%d,\"args\":{\"value\":%lld}}",
+			EXPORT_PID, value);
+}
+
+static void export_track(struct export_out* out, int tid, const char* name,
+		int order)
+{
+	export_begin(out);
+	fprintf(out->eo_file, "{\"name\":\"thread_name\",\"ph\":\"M\","
+			"\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", EXPORT_PID,
+			tid, name);
+	export_begin(out);
+	fprintf(out->eo_file, "{\"name\":\"thread_sort_index\",\"ph\":\"M\","
+			"\"pid\":%d,\"tid\":%d,\"args\":{\"sort_index\":%d}}", EXPORT_PID,
+			tid, order);
+}
+
+/*
+ * The ready queue key the built-in algo named gave a job, rebuilt from the
+ * task table (smaller runs first), or -1 for algos it can't be rebuilt for.
+ */
+static long long export_key(const char* algo, struct export_task* task,
+		long long t0, long long q)
+{
+	struct k_log_file_task* p = &task->et_param;
+	if (!strcmp(algo, "RMA") || !strcmp(algo, "GFP")) {
+		return p->ft_p;
+	} else if (!strcmp(algo, "EDF") || !strcmp(algo, "GEDF")
+			|| !strcmp(algo, "DL")) {
+		return (task->et_release - t0) / q + p->ft_d;
+	} else if (!strcmp(algo, "SCT")) {
+		return p->ft_c;
+	}
+	return -1;
+}
+
+int export_chrome(const char* trace_path, const char* json_path)
+{
+	struct k_log_file* file = k_log_file_open(trace_path);
+	if (!file) {
+		fprintf(stderr, "export: %s is not a readable trace file\n",
+				trace_path);
+		return -1;
+	}
+	FILE* json = fopen(json_path, "w");
+	if (!json) {
+		fprintf(stderr, "export: can't write %s\n", json_path);
+		k_log_file_close(file);
+		return -1;
+	}
+
+	const struct k_log_file_header* header = k_log_file_header(file);
+	if (header->fh_dropped) {
+		fprintf(stderr, "export: WARNING: %s lost %llu events before they "
+				"reached the file; its timeline has gaps\n", trace_path,
+				(unsigned long long) header->fh_dropped);
+	}
+	int n = header->fh_ntasks;
+	long long q = header->fh_quantum_ns;
+	int cores = header->fh_cores > 0 ? header->fh_cores : 1;
+
+	struct export_task* tasks = calloc(n ? n : 1, sizeof(*tasks));
+	struct export_task** open = calloc(n ? n : 1, sizeof(*open));
+	int nopen = 0;
+
+	struct export_out out;
+	out.eo_file = json;
+	out.eo_first = true;
+	out.eo_base = 0;
+	fprintf(json, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+	/* Name the process after the run, and give everyone a track */
+	export_begin(&out);
+	fprintf(json, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+			"\"args\":{\"name\":\"%s on set %d\"}}", EXPORT_PID,
+			header->fh_algo, header->fh_set);
+	export_track(&out, EXPORT_SCHED_TID, "scheduler", 0);
+
+	int i;
+	char name[32];
+	for (i = 0; i < n; i++) {
+		tasks[i].et_param = k_log_file_tasks(file)[i];
+		snprintf(name, sizeof(name), "task %d", tasks[i].et_param.ft_id);
+		export_track(&out, tasks[i].et_param.ft_id, name, i + 1);
+	}
+
+	long long t0 = -1; /* Start of the run: every task's first release */
+	long long ns;
+	long long ready = -1, key = -1;
+	int event, kind;
+	bool first = true;
+	while (k_log_file_next(file, &ns, &event, &kind)) {
+		if (first) out.eo_base = ns;
+		first = false;
+
+		const char* phase = NULL;
+		switch (event) {
+		case LOG_K_ALGO: phase = "schedule"; break;
+		case LOG_K_RELEASE: phase = "release"; break;
+		case LOG_K_RECALC: phase = "recalc"; break;
+		case LOG_K_FIXT: phase = "fixture"; break;
+		}
+		if (phase) {
+			if (t0 < 0 && event == LOG_K_ALGO && kind == LOG_K_BEG) t0 = ns;
+			export_slice(&out, phase, kind == LOG_K_BEG ? 'B' : 'E', ns,
+					EXPORT_SCHED_TID);
+			continue;
+		}
+
+		bool arrival = event >= LOG_K_ARRIVAL;
+		int id = arrival ? event - LOG_K_ARRIVAL : event;
+		struct export_task* task = NULL;
+		for (i = 0; i < n; i++) {
+			if (tasks[i].et_param.ft_id == id) task = &tasks[i];
+		}
+		if (!task) continue;
+		struct k_log_file_task* p = &task->et_param;
+
+		if (t0 < 0 && !arrival) t0 = ns;
+
+		/* As in the analyzer, a start preempts the latest open job */
+		if (arrival) {
+			/* An overrun predecessor sets the release, as in the analyzer */
+			long long due = task->et_release + p->ft_p * q;
+			task->et_next = task->et_late ? due : ns;
+			task->et_pending = true;
+			export_instant(&out, "release", ns, id);
+		} else if (kind == LOG_K_BEG && !task->et_open) {
+			if (task->et_pending) {
+				task->et_release = task->et_next > t0 ? task->et_next : t0;
+			} else {
+				task->et_release = task->et_jobs
+						? task->et_release + p->ft_p * q : t0;
+			}
+			task->et_pending = false;
+			task->et_jobs++;
+			task->et_open = true;
+			if (nopen >= cores) {
+				export_instant(&out, "preempted", ns,
+						open[nopen - 1]->et_param.ft_id);
+			}
+			open[nopen++] = task;
+			export_slice(&out, "job", 'B', ns, event);
+		} else if (kind == LOG_K_END && task->et_open) {
+			task->et_open = false;
+			task->et_late = ns > task->et_release + p->ft_p * q;
+			export_slice(&out, "job", 'E', ns, event);
+			if (ns > task->et_release + p->ft_d * q) {
+				export_instant(&out, "deadline miss", ns, event);
+			}
+
+			for (i = 0; open[i] != task; i++);
+			for (; i < nopen - 1; i++) open[i] = open[i + 1];
+			nopen--;
+		} else {
+			continue;
+		}
+
+		/* Released jobs not yet completed make up the ready queue */
+		long long now_ready = 0;
+		for (i = 0; i < n; i++) {
+			now_ready += tasks[i].et_pending + tasks[i].et_open;
+		}
+		if (now_ready != ready) {
+			export_counter(&out, "ready jobs", ns, now_ready);
+			ready = now_ready;
+		}
+
+		/* Priority of the job which is now running, 0 when idle */
+		long long now_key = nopen ? export_key(header->fh_algo,
+				open[nopen - 1], t0, q) : 0;
+		if (now_key != key && now_key >= 0) {
+			export_counter(&out, "running key", ns, now_key);
+			key = now_key;
+		}
+	}
+
+	fprintf(json, "\n]}\n");
+	fclose(json);
+	free(open);
+	free(tasks);
+	k_log_file_close(file);
+	return 0;
+}
@@ -0,0 +1,19 @@
+/*
+ * File: export.h
+ * Description: Export of binary k_log trace files for trace viewers
+ */
+
+#ifndef EXPORT_H_
+#define EXPORT_H_
+
+/*
+ * Convert a trace file written with FIXT_TRACE_FILES into Chrome trace-event
+ * JSON, which chrome://tracing and the Perfetto UI both open. Every task
+ * gets a track of its jobs and the scheduler a track of its phases, beside
+ * counters of the ready queue length and of the running job's priority.
+ * The trace is converted as it is read, so its length is not limited by
+ * memory. Returns 0 on success, or -1 if either file can't be opened.
+ */
+int export_chrome(const char* trace_path, const char* json_path);
+
+#endif
@@ -0,0 +1,334 @@
+/*
+ * File: bench.c
+ * Description: Micro-benchmarks for the scheduler's internal data structures
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "utlist.h"
+#include "fixt/fixt_task.h"
+#include "fixt/fixt_heap.h"
+#include "fixt/fixt_handoff.h"
+#include "fixt/fixt_set.h"
+#include "fixt/fixt_algo.h"
+#include "fixt/impl/edf/fixt_algo_impl_edf.h"
+#include "fixt/impl/rma/fixt_algo_impl_rma.h"
+#include "log/kernel_trace.h"
+#include "bench.h"
+
+/*
+ * Task set sizes to measure decision cost at.
+ */
+static const int BENCH_SIZES[] = { 3, 10, 100, 1000, 10000, 100000 };
+#define BENCH_NUM_SIZES (sizeof(BENCH_SIZES) / sizeof(BENCH_SIZES[0]))
+
+/*
+ * Roughly the number of task visits each measurement is allowed, so that
+ * the sort-based rebuild at 100k tasks still finishes in well under a second.
+ */
+#define BENCH_BUDGET 4000000
+
+static int64_t bench_now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+ * Build n tasks with pseudo-random periods in [2, 1000] quanta.
+ */
+static struct fixt_task** bench_tasks_new(int n)
+{
+	struct fixt_task** tasks = malloc(n * sizeof(*tasks));
+	srand(n);
+
+	int i;
+	for (i = 0; i < n; i++) {
+		int p = 2 + rand() % 999;
+		tasks[i] = fixt_task_new(i, 1, p, p);
+	}
+	return tasks;
+}
+
+static void bench_tasks_del(struct fixt_task** tasks, int n)
+{
+	int i;
+	for (i = 0; i < n; i++) {
+		fixt_task_del(tasks[i]);
+	}
+	free(tasks);
+}
+
+static int bench_key_comparator(void* l, void* r)
+{
+	struct fixt_task* task_l = (struct fixt_task*) l;
+	struct fixt_task* task_r = (struct fixt_task*) r;
+	return task_l->tk_ready.hn_key - task_r->tk_ready.hn_key;
+}
+
+/*
+ * One decision on the heap: take the head and move it to its next deadline.
+ */
+static double bench_heap_decisions(struct fixt_task** tasks, int n, int iters)
+{
+	struct fixt_heap heap;
+	fixt_heap_init(&heap, n, tk_ready);
+
+	int i;
+	for (i = 0; i < n; i++) {
+		fixt_heap_push(&heap, tasks[i], tasks[i]->tk_p);
+	}
+
+	int64_t init = bench_now_ns();
+	for (i = 0; i < iters; i++) {
+		struct fixt_task* head = fixt_heap_peek(&heap);
+		fixt_heap_rekey(&heap, head, head->tk_ready.hn_key + head->tk_p);
+	}
+	int64_t post = bench_now_ns();
+
+	fixt_heap_free(&heap);
+	return (post - init) / (double) iters;
+}
+
+/*
+ * One decision the old way: rebuild the queue list from scratch, sort it,
+ * then move the head to its next deadline.
+ */
+static double bench_sort_decisions(struct fixt_task** tasks, int n, int iters)
+{
+	int i, j;
+	for (i = 0; i < n; i++) {
+		tasks[i]->tk_ready.hn_key = tasks[i]->tk_p;
+	}
+
+	int64_t init = bench_now_ns();
+	for (i = 0; i < iters; i++) {
+		struct fixt_task* queue = NULL;
+		for (j = 0; j < n; j++) {
+			DL_APPEND2(queue, tasks[j], _tw_prev, _tw_next);
+		}
+		DL_SORT2(queue, (&bench_key_comparator), _tw_prev, _tw_next);
+		queue->tk_ready.hn_key += queue->tk_p;
+	}
+	int64_t post = bench_now_ns();
+
+	return (post - init) / (double) iters;
+}
+
+void bench_heap()
+{
+	printf(" [ Ready queue decision cost (ns/decision) ]\n");
+	printf(" %8s %12s %14s\n", "tasks", "heap", "sort rebuild");
+
+	unsigned s;
+	for (s = 0; s < BENCH_NUM_SIZES; s++) {
+		int n = BENCH_SIZES[s];
+		struct fixt_task** tasks = bench_tasks_new(n);
+
+		double heap_ns = bench_heap_decisions(tasks, n, BENCH_BUDGET / 4);
+
+		int iters = BENCH_BUDGET / n;
+		if (iters < 10) iters = 10;
+		double sort_ns = bench_sort_decisions(tasks, n, iters);
+
+		printf(" %8d %12.1f %14.1f\n", n, heap_ns, sort_ns);
+		bench_tasks_del(tasks, n);
+	}
+}
+
+/*
+ * Round trips per handoff measurement.
+ */
+#define BENCH_ROUND_TRIPS 100000
+
+/*
+ * Two one-way channels, like a task's cont and done, driven either by
+ * handoffs or by semaphores.
+ */
+struct bench_pingpong
+{
+	bool bp_sem; /* Use the semaphores instead of the handoffs */
+	struct fixt_handoff bp_ping_hf, bp_pong_hf;
+	sem_t bp_ping_sem, bp_pong_sem;
+};
+
+/*
+ * Plays the task: waits for every release and answers with a completion.
+ */
+static void* bench_pong(void* arg)
+{
+	struct bench_pingpong* pp = (struct bench_pingpong*) arg;
+
+	int i;
+	for (i = 0; i < BENCH_ROUND_TRIPS; i++) {
+		if (pp->bp_sem) {
+			sem_wait(&pp->bp_ping_sem);
+			sem_post(&pp->bp_pong_sem);
+		} else {
+			fixt_handoff_wait(&pp->bp_ping_hf);
+			fixt_handoff_post(&pp->bp_pong_hf);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Plays the scheduler: releases the task and waits for it to complete.
+ */
+static double bench_round_trips(bool sem, int spin)
+{
+	struct bench_pingpong pp;
+	pp.bp_sem = sem;
+	fixt_handoff_init(&pp.bp_ping_hf, spin);
+	fixt_handoff_init(&pp.bp_pong_hf, spin);
+	sem_init(&pp.bp_ping_sem, 0, 0);
+	sem_init(&pp.bp_pong_sem, 0, 0);
+
+	pthread_t pong;
+	pthread_create(&pong, NULL, &bench_pong, &pp);
+
+	int64_t init = bench_now_ns();
+	int i;
+	for (i = 0; i < BENCH_ROUND_TRIPS; i++) {
+		if (sem) {
+			sem_post(&pp.bp_ping_sem);
+			sem_wait(&pp.bp_pong_sem);
+		} else {
+			fixt_handoff_post(&pp.bp_ping_hf);
+			fixt_handoff_wait(&pp.bp_pong_hf);
+		}
+	}
+	int64_t post = bench_now_ns();
+
+	pthread_join(pong, NULL);
+	fixt_handoff_destroy(&pp.bp_ping_hf);
+	fixt_handoff_destroy(&pp.bp_pong_hf);
+	sem_destroy(&pp.bp_ping_sem);
+	sem_destroy(&pp.bp_pong_sem);
+	return (post - init) / (double) BENCH_ROUND_TRIPS;
+}
+
+void bench_handoff()
+{
+	printf(" [ Handoff round trip (ns/round trip) ]\n");
+	printf(" %12s %12s %12s\n", "semaphore", "handoff", "spin+park");
+
+	double sem_ns = bench_round_trips(true, 0);
+	double park_ns = bench_round_trips(false, 0);
+	double spin_ns = bench_round_trips(false, FIXT_HANDOFF_SPIN);
+
+	printf(" %12.1f %12.1f %12.1f\n", sem_ns, park_ns, spin_ns);
+}
+
+/*
+ * Set sizes and decisions per dispatch measurement.
+ */
+static const int BENCH_DISPATCH_SIZES[] = { 3, 10, 100, 1000 };
+#define BENCH_DISPATCH_NUM_SIZES \
+	(sizeof(BENCH_DISPATCH_SIZES) / sizeof(BENCH_DISPATCH_SIZES[0]))
+#define BENCH_DECISIONS 200000
+#define BENCH_DISPATCH_TRIES 5
+
+/*
+ * Build a set of n unit tasks with periods in [2n, 4n) quanta, so that its
+ * utilization stays under ln 2 and neither EDF nor RMA stops on a miss.
+ */
+static struct fixt_set* bench_set_new(int n)
+{
+	struct fixt_set* set = fixt_set_alloc(0, n);
+	srand(n);
+
+	int i;
+	for (i = 0; i < n; i++) {
+		int p = 2 * n + rand() % (2 * n);
+		fixt_set_add(set, i, 1, p, p);
+	}
+	return set;
+}
+
+/*
+ * Make simulated scheduling decisions on a clone of proto, through its
+ * specialized step or, if hooks is set, through the hook pointers. The
+ * best of BENCH_DISPATCH_TRIES runs is kept, since the gap being measured
+ * is smaller than the run-to-run noise of a shared machine.
+ */
+static double bench_steps(struct fixt_algo* proto, struct fixt_set* set,
+		bool hooks)
+{
+	double best = 0;
+	int t;
+	for (t = 0; t < BENCH_DISPATCH_TRIES; t++) {
+		struct fixt_algo* algo = fixt_algo_clone(proto);
+		if (hooks) algo->al_step = NULL;
+		fixt_algo_load(algo, set);
+		fixt_algo_simulate(algo, true);
+		fixt_algo_init(algo);
+
+		int64_t init = bench_now_ns();
+		int i;
+		for (i = 0; i < BENCH_DECISIONS; i++) {
+			fixt_algo_step(algo);
+		}
+		int64_t post = bench_now_ns();
+
+		fixt_algo_halt(algo);
+		fixt_algo_del(algo);
+
+		double ns = (post - init) / (double) BENCH_DECISIONS;
+		if (t == 0 || ns < best) best = ns;
+	}
+	return best;
+}
+
+void bench_dispatch()
+{
+	printf(" [ Scheduling decision cost (ns/decision) ]\n");
+	if (!FIXT_ALGO_STATIC_DISPATCH) {
+		printf(" (FIXT_ALGO_STATIC_DISPATCH is off: both columns use hooks)\n");
+	}
+	if (LOG_K_METHOD) {
+		printf(" (k_log events are on: build with -DLOG_K_METHOD=0 to time "
+				"the decisions alone)\n");
+	}
+	printf(" %8s %12s %12s %12s %12s\n", "tasks", "edf hooks", "edf static",
+			"rma hooks", "rma static");
+
+	/* Keep the simulated runs out of the global trace */
+	struct k_log_csv* trace = k_log_csv_new();
+	k_log_csv_bind(trace);
+
+	struct fixt_algo* edf = fixt_algo_impl_edf_new();
+	struct fixt_algo* rma = fixt_algo_impl_rma_new();
+
+	unsigned s;
+	for (s = 0; s < BENCH_DISPATCH_NUM_SIZES; s++) {
+		int n = BENCH_DISPATCH_SIZES[s];
+		struct fixt_set* set = bench_set_new(n);
+
+		double edf_hooks = bench_steps(edf, set, true);
+		double edf_static = bench_steps(edf, set, false);
+		double rma_hooks = bench_steps(rma, set, true);
+		double rma_static = bench_steps(rma, set, false);
+
+		printf(" %8d %12.1f %12.1f %12.1f %12.1f\n", n, edf_hooks,
+				edf_static, rma_hooks, rma_static);
+		fixt_set_del(set);
+	}
+
+	fixt_algo_del(edf);
+	fixt_algo_del(rma);
+	k_log_csv_bind(NULL);
+	k_log_csv_del(trace);
+}
+
+void bench_run()
+{
+	bench_heap();
+	bench_handoff();
+	bench_dispatch();
+}
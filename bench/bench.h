@@ -0,0 +1,34 @@
+/*
+ * File: bench.h
+ * Description: Micro-benchmarks for the scheduler's internal data structures
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/*
+ * Run every benchmark and print the results to stdout.
+ */
+void bench_run();
+
+/*
+ * Measure the cost of a single scheduling decision on the ready queue heap
+ * against the sort-based queue rebuild it replaced, for growing set sizes.
+ */
+void bench_heap();
+
+/*
+ * Measure the round trip of a scheduler/task handoff between two threads,
+ * with fixt_handoff (parking at once, and spinning first) against the POSIX
+ * semaphores it replaced.
+ */
+void bench_handoff();
+
+/*
+ * Measure the cost of a whole simulated scheduling decision (schedule,
+ * release, block and recalc) through the algorithm hooks against the step
+ * specialized at compile time, for growing set sizes.
+ */
+void bench_dispatch();
+
+#endif
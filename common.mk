@@ -11,13 +11,18 @@ include $(QCONFIG)
 USEFILE=
 
 #===== LIBS - a space-separated list of library items to be included in the link.
-LIBS+=c socket
+LIBS+=c socket m
 
 #===== EXTRA_SRCVPATH - a space-separated list of directories to search for source files.
 EXTRA_SRCVPATH+=$(PROJECT_ROOT)/fixt $(PROJECT_ROOT)/spin  \
 	$(PROJECT_ROOT)/fixt/impl/rma  \
 	$(PROJECT_ROOT)/fixt/impl/edf  \
-	$(PROJECT_ROOT)/fixt/impl/sct $(PROJECT_ROOT)/log
+	$(PROJECT_ROOT)/fixt/impl/sct  \
+	$(PROJECT_ROOT)/fixt/impl/gedf  \
+	$(PROJECT_ROOT)/fixt/impl/gfp $(PROJECT_ROOT)/log  \
+	$(PROJECT_ROOT)/fixt/impl/dl  \
+	$(PROJECT_ROOT)/bench $(PROJECT_ROOT)/analyze $(PROJECT_ROOT)/plat  \
+	$(PROJECT_ROOT)/sweep
 
 include $(MKFILES_ROOT)/qmacros.mk
 ifndef QNX_INTERNAL
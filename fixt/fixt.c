@@ -6,21 +6,33 @@
  */
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <signal.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
 #include "utlist.h"
 #include "fixt/impl/rma/fixt_algo_impl_rma.h"
 #include "fixt/impl/edf/fixt_algo_impl_edf.h"
 #include "fixt/impl/sct/fixt_algo_impl_sct.h"
+#include "fixt/impl/gedf/fixt_algo_impl_gedf.h"
+#include "fixt/impl/gfp/fixt_algo_impl_gfp.h"
+#include "fixt/impl/dl/fixt_algo_impl_dl.h"
 #include "fixt_set.h"
 #include "fixt_algo.h"
 #include "fixt_task.h"
+#include "fixt_analysis.h"
+#include "fixt_cpu.h"
+#include "fixt_partition.h"
+#include "fixt_pool.h"
 #include "fixt.h"
 #include "spin/spin.h"
 #include "spin/timing.h"
+#include "plat/plat.h"
 
 #include "log/log.h"
 #include "log/kernel_trace.h"
+#include "log/trace_file.h"
 
 /*
  * A global doubly linked list (DL*) of task sets.
@@ -32,6 +44,16 @@ static struct fixt_set* set_list = NULL;
  */
 static struct fixt_algo* algo_list = NULL;
 
+/**
+ * A global doubly linked list (DL*) of global multiprocessor algorithms
+ */
+static struct fixt_algo* global_list = NULL;
+
+/**
+ * A global doubly linked list (DL*) of algorithms scheduled by the kernel
+ */
+static struct fixt_algo* kernel_list = NULL;
+
 static void register_tasks(); /* User task sets go here */
 static void register_algos(); /* User pulls in algorithms here */
 
@@ -46,14 +68,116 @@ static void prime_algo(struct fixt_algo*, struct fixt_set*);
 
 /*
  * Run a test on the primed task set for a limited run. The run is
- * limited by FIXT_SECONDS_PER_TEST. Otherwise, algo simulations are infinite.
+ * limited by FIXT_SECONDS_PER_TEST (or FIXT_SIM_QUANTA_PER_TEST when
+ * simulating). Otherwise, algo simulations are infinite.
  */
 static void run_test_on(struct fixt_algo*);
 
+/*
+ * One combination of algorithm and task set, and what testing it found.
+ */
+struct fixt_pair
+{
+	struct fixt_algo* pr_algo; /* Algo as registered in algo_list */
+	struct fixt_set* pr_set; /* Set as registered in set_list */
+	int pr_a, pr_s; /* Positions in algo_list and set_list */
+
+	enum fixt_verdict pr_verdict; /* Offline analysis of the pair */
+	bool pr_ran; /* False if the analysis alone decided the pair */
+	bool pr_schedulable; /* Outcome of the run */
+	int pr_misses; /* Deadline misses of the run on the clock */
+	long long pr_late_ns; /* Their tardiness */
+	struct k_log_csv* pr_trace; /* Events of a parallel run (NULL: global) */
+};
+
+/*
+ * Shared by the parallel workers, which take pairs off of it in order.
+ */
+struct fixt_runner
+{
+	struct fixt_pair* rn_pairs;
+	int rn_count;
+	int rn_next; /* Index of the next pair nobody has taken yet */
+	pthread_mutex_t rn_lock;
+};
+
+struct fixt_worker
+{
+	struct fixt_runner* wk_runner;
+	int wk_cpu; /* The processor this worker has to itself */
+	pthread_t wk_thread;
+};
+
+/*
+ * Allocate every (algo, set) combination in test order. Returns the count.
+ */
+static int list_pairs(struct fixt_pair**);
+
+/*
+ * Decide how many pairs to test at once: one per processor not reserved
+ * for the rest of the system, or 1 to test sequentially.
+ */
+static int count_workers(int pairs);
+
+/*
+ * Test a single pair on the given algo and set, which may be copies of the
+ * registered ones. Returns once the run is over and the results are in.
+ */
+static void test_pair(struct fixt_pair*, struct fixt_algo*, struct fixt_set*);
+static void report_pair(struct fixt_pair*);
+
+/*
+ * Test all pairs, each worker on a processor of its own. Each pair runs on
+ * private copies of its algo and set with a trace buffer of its own, so
+ * pairs on different processors share no state.
+ */
+static void run_pairs_parallel(struct fixt_pair*, int count, int workers);
+static void* pair_worker(void*);
+
+/*
+ * One core of a partitioned run: its own algo instance and share of the set.
+ */
+struct fixt_core
+{
+	struct fixt_algo* cr_algo;
+	struct fixt_set* cr_set;
+	int cr_cpu; /* Processor to pin to, or FIXT_CPU_ANY */
+	struct k_log_csv* cr_trace; /* Events of a concurrent core (NULL: global) */
+	bool cr_schedulable;
+	int cr_jobs; /* Jobs the core completed */
+	pthread_t cr_thread;
+};
+
+/*
+ * Test every pair partitioned across FIXT_PARTITION_CORES cores, once per
+ * bin-packing heuristic. A pair passes if every one of its cores passes.
+ */
+static void test_partitioned();
+static void* core_worker(void*);
+
+/*
+ * Test every set under each global algo across FIXT_GLOBAL_CORES cores.
+ */
+static void test_global();
+
+/*
+ * Test every set under each algo which leaves scheduling to the kernel, one
+ * pair at a time, numbered on from the algos of fixt_test. Each is reported
+ * next to the clock misses of EDF's run of the set, out of the n pairs of
+ * fixt_test.
+ */
+static void test_kernel(struct fixt_pair* pairs, int n);
+
 void fixt_init()
 {
+	k_log_drain_start();
 	k_log_s(LOG_K_FIXT);
-	spin_calibrate();
+#if !FIXT_SIMULATE
+	plat_rt_init(); /* Simulated runs have no real-time threads */
+	spin_calibrate(); /* Simulated tasks never spin */
+	spin_monitor_start();
+	fixt_pool_init(FIXT_POOL_THREADS); /* Nor do they need threads */
+#endif
 	register_tasks();
 	register_algos();
 	k_log_e(LOG_K_FIXT);
@@ -64,23 +188,41 @@ void fixt_test()
 	log_func(0, "fixt_test");
 
 	/* Run each combination of algorithm and task set */
-	struct fixt_algo* algo; int a = 0;
-	DL_FOREACH(algo_list, algo) {
-		struct fixt_set* set; int s = 0;
-		DL_FOREACH(set_list, set) {
-			prime_algo(algo, set);
-			run_test_on(algo); /* Returns if algo becomes unschedulable */
-
-			if(algo->al_schedulable) {
-				printf(" [ ALGO %d TEST SET %d PASS ]\n", a, s);
-			} else {
-				printf(" [ ALGO %d TEST SET %d FAIL ]\n", a, s);
-			}
-			s++;
+	struct fixt_pair* pairs;
+	int n = list_pairs(&pairs);
+	int workers = count_workers(n);
+
+	int i;
+	if (workers > 1) {
+		run_pairs_parallel(pairs, n, workers);
+		for (i = 0; i < n; i++) {
+			report_pair(&pairs[i]);
+		}
+	} else {
+		for (i = 0; i < n; i++) {
+			test_pair(&pairs[i], pairs[i].pr_algo, pairs[i].pr_set);
+			report_pair(&pairs[i]);
 		}
-		a++;
 	}
 
+	/* Parallel runs traced into buffers of their own */
+	for (i = 0; i < n; i++) {
+		if (!pairs[i].pr_trace) continue;
+#if LOG_K_METHOD == 2
+		printf(" [ ALGO %d TEST SET %d TRACE ]\n", pairs[i].pr_a,
+				pairs[i].pr_s);
+		k_log_csv_print_trace(pairs[i].pr_trace);
+#endif
+		k_log_csv_del(pairs[i].pr_trace);
+	}
+#if FIXT_KERNEL_EDF
+	test_kernel(pairs, n);
+#endif
+	free(pairs);
+
+	if (FIXT_PARTITION_CORES > 1) test_partitioned();
+	if (FIXT_GLOBAL_CORES > 1) test_global();
+
 	log_fend(0, "fixt_test");
 }
 
@@ -90,6 +232,11 @@ void fixt_term()
 
 	clean_tasks();
 	clean_algos();
+#if !FIXT_SIMULATE
+	fixt_pool_term();
+	spin_monitor_stop();
+#endif
+	k_log_drain_stop();
 
 	log_fend(0, "fixt_term");
 }
@@ -129,11 +276,32 @@ static void register_tasks()
 			1, 3, 3,
 			1, 2, 2);
 
+	/* Task set #5 - Over one core (U = 1.28), fits two cores */
+	struct fixt_set* set5 = fixt_set_new(5, 4*3,
+			1, 2, 2,
+			1, 3, 3,
+			1, 4, 4,
+			1, 5, 5);
+
+	/* Task set #6 - Set #1's tuples, with jobs which touch memory */
+	struct fixt_set* set6 = fixt_set_new(6, 5*3,
+			1, 7, 7,
+			2, 5, 5,
+			1, 8, 8,
+			1, 10, 10,
+			2, 16, 16);
+	fixt_task_set_work(&set6->ts_tasks[0], SPIN_WORK_STREAM, 0);
+	fixt_task_set_work(&set6->ts_tasks[1], SPIN_WORK_CHASE, 8 << 20);
+	fixt_task_set_work(&set6->ts_tasks[2], SPIN_WORK_SIMD, 0);
+	fixt_task_set_work(&set6->ts_tasks[3], SPIN_WORK_MIXED, 0);
+	fixt_task_set_work(&set6->ts_tasks[4], SPIN_WORK_CHASE, 256 << 10);
 
 	DL_APPEND(set_list, set1);
 	DL_APPEND(set_list, set2);
 	DL_APPEND(set_list, set3);
 	//DL_APPEND(set_list, set4);
+	DL_APPEND(set_list, set5); /* Fails unless partitioned */
+	DL_APPEND(set_list, set6);
 	/* @formatter:on */
 }
 
@@ -164,6 +332,22 @@ static void register_algos()
 	DL_APPEND(algo_list, rma);
 	DL_APPEND(algo_list, edf);
 	DL_APPEND(algo_list, sct);
+
+	global_list = NULL;
+
+	struct fixt_algo* gedf = fixt_algo_impl_gedf_new(FIXT_GLOBAL_CORES);
+	struct fixt_algo* gfp = fixt_algo_impl_gfp_new(FIXT_GLOBAL_CORES);
+
+	DL_APPEND(global_list, gedf);
+	DL_APPEND(global_list, gfp);
+
+	kernel_list = NULL;
+
+#if FIXT_KERNEL_EDF
+	struct fixt_algo* dl = fixt_algo_impl_dl_new();
+
+	DL_APPEND(kernel_list, dl);
+#endif
 }
 
 static void clean_algos()
@@ -173,17 +357,23 @@ static void clean_algos()
 		DL_DELETE(algo_list, elt);
 		fixt_algo_del(elt);
 	}
+	DL_FOREACH_SAFE(global_list, elt, tmp) {
+		DL_DELETE(global_list, elt);
+		fixt_algo_del(elt);
+	}
+	DL_FOREACH_SAFE(kernel_list, elt, tmp) {
+		DL_DELETE(kernel_list, elt);
+		fixt_algo_del(elt);
+	}
 }
 
 static void prime_algo(struct fixt_algo* algo, struct fixt_set* set)
 {
 	log_func(1, "prime_algo");
 
-	/* Copy the task set over to the algorithms internal data */
-	struct fixt_task* elt;
-	DL_FOREACH2(set->ts_set_head, elt, _ts_next) {
-		fixt_algo_add_task(algo, elt);
-	}
+	/* Hand the set's task table over to the algorithm */
+	fixt_algo_load(algo, set);
+	fixt_algo_simulate(algo, FIXT_SIMULATE);
 	fixt_algo_init(algo);
 
 	log_fend(1, "prime_algo");
@@ -199,18 +389,410 @@ static void run_test_on(struct fixt_algo* algo)
 	 */
 	struct timespec init, post, elap;
 	clock_gettime(CLOCK_REALTIME, &init);
+	bool more;
 	do {
-		fixt_algo_schedule(algo);
-		if(algo->al_schedulable) {
-			fixt_algo_run(algo);
-		} else {
+		fixt_algo_step(algo);
+		if (!algo->al_schedulable && !algo->al_soft) {
 			/* Algo is no longer schedulable. End test and halt threads */
 			break;
 		}
-		clock_gettime(CLOCK_REALTIME, &post);
-		timing_timespec_sub(&elap, &post, &init);
-	} while (elap.tv_sec < FIXT_SECONDS_PER_TEST);
+
+		if (algo->al_simulated) {
+			more = algo->al_now < FIXT_SIM_QUANTA_PER_TEST;
+		} else {
+			clock_gettime(CLOCK_REALTIME, &post);
+			timing_timespec_sub(&elap, &post, &init);
+			more = elap.tv_sec < FIXT_SECONDS_PER_TEST;
+		}
+	} while (more);
 	fixt_algo_halt(algo);
+	fixt_algo_report(algo);
 
 	log_fend(1, "run_test_on");
 }
+
+static int list_pairs(struct fixt_pair** pairs)
+{
+	struct fixt_algo* algo;
+	struct fixt_set* set;
+	int algos, sets;
+	DL_COUNT(algo_list, algo, algos);
+	DL_COUNT(set_list, set, sets);
+
+	*pairs = calloc(algos * sets, sizeof(struct fixt_pair));
+
+	int n = 0, a = 0;
+	DL_FOREACH(algo_list, algo) {
+		int s = 0;
+		DL_FOREACH(set_list, set) {
+			struct fixt_pair* pair = &(*pairs)[n++];
+			pair->pr_algo = algo;
+			pair->pr_set = set;
+			pair->pr_a = a;
+			pair->pr_s = s;
+			pair->pr_trace = NULL;
+			s++;
+		}
+		a++;
+	}
+
+	return n;
+}
+
+static int count_workers(int pairs)
+{
+#if FIXT_PARALLEL
+	int workers = fixt_cpu_count() - FIXT_PARALLEL_RESERVED_CPUS;
+	return workers < pairs ? workers : pairs;
+#else
+	return 1;
+#endif
+}
+
+/*
+ * Create the binary trace file of a pair, described by its algo and set.
+ */
+static struct k_log_file* open_trace_file(struct fixt_pair* pair,
+		struct fixt_algo* algo, struct fixt_set* set)
+{
+	struct k_log_file_header header;
+	memset(&header, 0, sizeof(header));
+	header.fh_quantum_ns = SPIN_QUANTUM_WIDTH_MS * 1000000LL;
+	header.fh_virtual = FIXT_SIMULATE;
+	header.fh_cores = algo->al_cores;
+	header.fh_set = set->ts_id;
+	header.fh_ntasks = set->ts_count;
+	strncpy(header.fh_algo, algo->al_name, K_LOG_FILE_NAME - 1);
+
+	struct k_log_file_task* tasks = malloc(set->ts_count * sizeof(*tasks));
+	int i;
+	for (i = 0; i < set->ts_count; i++) {
+		tasks[i].ft_id = set->ts_tasks[i].tk_id;
+		tasks[i].ft_c = set->ts_tasks[i].tk_c;
+		tasks[i].ft_p = set->ts_tasks[i].tk_p;
+		tasks[i].ft_d = set->ts_tasks[i].tk_d;
+	}
+
+	char path[128];
+	snprintf(path, sizeof(path), "%s/fixt-a%d-s%d.klog", FIXT_TRACE_DIR,
+			pair->pr_a, pair->pr_s);
+	struct k_log_file* file = k_log_file_create(path, &header, tasks);
+	free(tasks);
+	return file;
+}
+
+static void test_pair(struct fixt_pair* pair, struct fixt_algo* algo,
+		struct fixt_set* set)
+{
+	pair->pr_verdict = fixt_algo_analyze(algo, set);
+	pair->pr_ran = false;
+
+#if FIXT_ANALYSIS_MODE == 2
+	if (pair->pr_verdict != FIXT_VERDICT_UNKNOWN) return;
+#endif
+	struct k_log_file* file = NULL;
+	if (FIXT_TRACE_FILES) {
+		file = open_trace_file(pair, algo, set);
+		if (file) k_log_csv_stream(k_log_csv_current(), file);
+	}
+
+	prime_algo(algo, set);
+	run_test_on(algo); /* Returns if algo becomes unschedulable */
+
+	if (file) {
+		k_log_csv_stream(k_log_csv_current(), NULL);
+		k_log_file_close(file);
+	}
+
+	pair->pr_ran = true;
+	pair->pr_schedulable = algo->al_schedulable;
+	pair->pr_misses = fixt_algo_misses(algo, &pair->pr_late_ns);
+}
+
+static void report_pair(struct fixt_pair* pair)
+{
+	int a = pair->pr_a, s = pair->pr_s;
+	enum fixt_verdict verdict = pair->pr_verdict;
+
+	if (!pair->pr_ran) {
+		printf(" [ ALGO %d TEST SET %d %s ] (analysis)\n", a, s,
+				fixt_verdict_str(verdict));
+		return;
+	}
+
+	if(pair->pr_schedulable) {
+		printf(" [ ALGO %d TEST SET %d PASS ]\n", a, s);
+	} else {
+		printf(" [ ALGO %d TEST SET %d FAIL ]\n", a, s);
+	}
+
+#if FIXT_ANALYSIS_MODE == 1
+	/* A run only covers FIXT_SECONDS_PER_TEST, so a miss may lie past it */
+	if (verdict != FIXT_VERDICT_UNKNOWN
+			&& (verdict == FIXT_VERDICT_PASS) != pair->pr_schedulable) {
+		printf(" [ ALGO %d TEST SET %d ANALYSIS SAYS %s ]\n", a, s,
+				fixt_verdict_str(verdict));
+	}
+#endif
+}
+
+static void run_pairs_parallel(struct fixt_pair* pairs, int count, int workers)
+{
+	log_func(1, "run_pairs_parallel");
+
+	struct fixt_runner runner;
+	runner.rn_pairs = pairs;
+	runner.rn_count = count;
+	runner.rn_next = 0;
+	pthread_mutex_init(&runner.rn_lock, NULL);
+
+	/* Processors below FIXT_PARALLEL_RESERVED_CPUS stay with the system */
+	struct fixt_worker* worker = calloc(workers, sizeof(*worker));
+	int w;
+	for (w = 0; w < workers; w++) {
+		worker[w].wk_runner = &runner;
+		worker[w].wk_cpu = FIXT_PARALLEL_RESERVED_CPUS + w;
+		pthread_create(&worker[w].wk_thread, NULL, &pair_worker, &worker[w]);
+	}
+	for (w = 0; w < workers; w++) {
+		pthread_join(worker[w].wk_thread, NULL);
+	}
+
+	free(worker);
+	pthread_mutex_destroy(&runner.rn_lock);
+
+	log_fend(1, "run_pairs_parallel");
+}
+
+static void* pair_worker(void* arg)
+{
+	struct fixt_worker* worker = (struct fixt_worker*) arg;
+	struct fixt_runner* runner = worker->wk_runner;
+
+	fixt_cpu_pin(worker->wk_cpu);
+
+	while (true) {
+		pthread_mutex_lock(&runner->rn_lock);
+		int next = runner->rn_next++;
+		pthread_mutex_unlock(&runner->rn_lock);
+		if (next >= runner->rn_count) break;
+
+		/* Tasks and algos carry run state, so each run needs its own */
+		struct fixt_pair* pair = &runner->rn_pairs[next];
+		struct fixt_algo* algo = fixt_algo_clone(pair->pr_algo);
+		struct fixt_set* set = fixt_set_clone(pair->pr_set);
+		fixt_algo_pin(algo, worker->wk_cpu);
+
+		pair->pr_trace = k_log_csv_new();
+		k_log_csv_bind(pair->pr_trace);
+		test_pair(pair, algo, set);
+		k_log_csv_bind(NULL);
+
+		fixt_algo_del(algo);
+		fixt_set_del(set);
+	}
+
+	return NULL;
+}
+
+static void test_partitioned()
+{
+	log_func(1, "test_partitioned");
+
+	struct fixt_pair* pairs;
+	int n = list_pairs(&pairs);
+
+	/* Cores only run side by side if each can have a processor to itself */
+	const int cores = FIXT_PARTITION_CORES;
+	bool concurrent = (fixt_cpu_count() - FIXT_PARALLEL_RESERVED_CPUS >= cores);
+
+	int i, k;
+	enum fixt_partition_fit fit;
+	for (i = 0; i < n; i++) {
+		struct fixt_pair* pair = &pairs[i];
+		for (fit = FIXT_PARTITION_FIRST_FIT; fit <= FIXT_PARTITION_WORST_FIT;
+				fit++) {
+			const char* name = fixt_partition_fit_str(fit);
+			struct fixt_set** part = fixt_partition(pair->pr_set, cores, fit,
+					pair->pr_algo->al_analyze);
+			if (!part) {
+				printf(" [ ALGO %d TEST SET %d %s %d CORES NO FIT ]\n",
+						pair->pr_a, pair->pr_s, name, cores);
+				continue;
+			}
+
+			struct fixt_core core[cores];
+			for (k = 0; k < cores; k++) {
+				core[k].cr_algo = fixt_algo_clone(pair->pr_algo);
+				core[k].cr_set = part[k];
+				core[k].cr_cpu = concurrent ?
+						FIXT_PARALLEL_RESERVED_CPUS + k : FIXT_CPU_ANY;
+				core[k].cr_trace = concurrent ? k_log_csv_new() : NULL;
+			}
+
+			if (concurrent) {
+				for (k = 0; k < cores; k++) {
+					pthread_create(&core[k].cr_thread, NULL, &core_worker,
+							&core[k]);
+				}
+				for (k = 0; k < cores; k++) {
+					pthread_join(core[k].cr_thread, NULL);
+				}
+			} else {
+				for (k = 0; k < cores; k++) {
+					core_worker(&core[k]);
+				}
+			}
+
+			bool schedulable = true;
+			int jobs = 0;
+			for (k = 0; k < cores; k++) {
+				schedulable &= core[k].cr_schedulable;
+				jobs += core[k].cr_jobs;
+			}
+			printf(" [ ALGO %d TEST SET %d %s %d CORES %s ] jobs %d\n",
+					pair->pr_a, pair->pr_s, name, cores,
+					schedulable ? "PASS" : "FAIL", jobs);
+
+			for (k = 0; k < cores; k++) {
+#if LOG_K_METHOD == 2
+				if (core[k].cr_trace) {
+					printf(" [ ALGO %d TEST SET %d %s CORE %d TRACE ]\n",
+							pair->pr_a, pair->pr_s, name, k);
+					k_log_csv_print_trace(core[k].cr_trace);
+				}
+#endif
+				k_log_csv_del(core[k].cr_trace);
+				fixt_algo_del(core[k].cr_algo);
+			}
+			fixt_partition_del(part, cores);
+		}
+	}
+	free(pairs);
+
+	log_fend(1, "test_partitioned");
+}
+
+static void* core_worker(void* arg)
+{
+	struct fixt_core* core = (struct fixt_core*) arg;
+
+	/* A core with nothing to run idles forever, and trivially passes */
+	if (!core->cr_set->ts_count) {
+		core->cr_schedulable = true;
+		core->cr_jobs = 0;
+		return NULL;
+	}
+
+	k_log_csv_bind(core->cr_trace);
+	fixt_algo_pin(core->cr_algo, core->cr_cpu);
+	prime_algo(core->cr_algo, core->cr_set);
+	run_test_on(core->cr_algo);
+	core->cr_schedulable = core->cr_algo->al_schedulable;
+	core->cr_jobs = core->cr_algo->al_jobs;
+	k_log_csv_bind(NULL);
+
+	return NULL;
+}
+
+static void test_global()
+{
+	log_func(1, "test_global");
+
+	/*
+	 * Cores are only real if each has a processor to itself. Sharing one,
+	 * the model would charge every dispatched job a full quantum the
+	 * processor never gave it.
+	 */
+	const int cores = FIXT_GLOBAL_CORES;
+	int spare = fixt_cpu_count() - FIXT_PARALLEL_RESERVED_CPUS;
+	if (spare < cores) {
+		printf(" [ GLOBAL %d CORES SKIPPED ] %d spare processors\n", cores,
+				spare > 0 ? spare : 0);
+		log_fend(1, "test_global");
+		return;
+	}
+	const int cpu = FIXT_PARALLEL_RESERVED_CPUS;
+
+	struct fixt_algo* elt;
+	struct fixt_set* set;
+	int a = 0;
+	DL_FOREACH(global_list, elt) {
+		int s = 0;
+		DL_FOREACH(set_list, set) {
+			struct fixt_algo* algo = fixt_algo_clone(elt);
+			struct fixt_set* copy = fixt_set_clone(set);
+			fixt_algo_pin(algo, cpu);
+
+			prime_algo(algo, copy);
+			run_test_on(algo);
+
+			/* The clock has the last word on a miss, not just the model */
+			long long late_ns;
+			int misses = fixt_algo_misses(algo, &late_ns);
+			bool pass = algo->al_schedulable && !misses;
+
+			printf(" [ GLOBAL ALGO %d TEST SET %d %d CORES %s ] jobs %d "
+					"tardiness %d migrations %d preemptions %d clock misses "
+					"%d clock tardiness us %.1f\n", a, s, cores,
+					pass ? "PASS" : "FAIL", algo->al_jobs, algo->al_tardiness,
+					algo->al_migrations, algo->al_preemptions, misses,
+					late_ns / 1000.0);
+
+			fixt_algo_del(algo);
+			fixt_set_del(copy);
+			s++;
+		}
+		a++;
+	}
+
+	log_fend(1, "test_global");
+}
+
+static void test_kernel(struct fixt_pair* pairs, int n)
+{
+	log_func(1, "test_kernel");
+
+	/* Trace files are named by position, so carry on from algo_list */
+	struct fixt_algo* elt;
+	struct fixt_set* set;
+	int a;
+	DL_COUNT(algo_list, elt, a);
+	DL_FOREACH(kernel_list, elt) {
+		int s = 0;
+		DL_FOREACH(set_list, set) {
+			struct fixt_pair pair;
+			memset(&pair, 0, sizeof(pair));
+			pair.pr_algo = elt;
+			pair.pr_set = set;
+			pair.pr_a = a;
+			pair.pr_s = s;
+
+			test_pair(&pair, elt, set);
+
+			/* Both are EDF, so compare what the clock saw of each */
+			struct fixt_pair* edf = NULL;
+			int i;
+			for (i = 0; i < n; i++) {
+				if (pairs[i].pr_s == s && pairs[i].pr_ran
+						&& !strcmp(pairs[i].pr_algo->al_name, "EDF")) {
+					edf = &pairs[i];
+				}
+			}
+			bool pass = pair.pr_schedulable && !pair.pr_misses;
+			printf(" [ ALGO %d TEST SET %d %s ] clock misses %d clock "
+					"tardiness us %.1f", a, s, pass ? "PASS" : "FAIL",
+					pair.pr_misses, pair.pr_late_ns / 1000.0);
+			if (edf) {
+				printf(", EDF clock misses %d clock tardiness us %.1f\n",
+						edf->pr_misses, edf->pr_late_ns / 1000.0);
+			} else {
+				printf(", EDF not run\n");
+			}
+			s++;
+		}
+		a++;
+	}
+
+	log_fend(1, "test_kernel");
+}
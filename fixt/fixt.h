@@ -14,6 +14,78 @@
  */
 #define FIXT_SECONDS_PER_TEST 1
 
+/**
+ * When set, tests run as a thread-free discrete-event simulation against a
+ * virtual clock rather than on real threads. Decisions and the k_log stream
+ * match a threaded run, but a simulated test lasts FIXT_SIM_QUANTA_PER_TEST
+ * quanta of virtual time and finishes as fast as the host can schedule.
+ */
+#define FIXT_SIMULATE 0
+#define FIXT_SIM_QUANTA_PER_TEST 100 /* Same span as FIXT_SECONDS_PER_TEST */
+
+/**
+ * When set, fixt_test runs (algo, set) pairs concurrently, one per processor,
+ * pinning each pair's scheduler and task threads to that processor. The first
+ * FIXT_PARALLEL_RESERVED_CPUS processors are left to the main thread and the
+ * rest of the system. Hosts without a spare processor test sequentially.
+ */
+#define FIXT_PARALLEL 1
+#define FIXT_PARALLEL_RESERVED_CPUS 1
+
+/**
+ * When above 1, fixt_test goes on to run each (algo, set) pair partitioned
+ * across this many cores, once per bin-packing heuristic (FFD, BFD, WFD).
+ * Each core runs its own instance of the algo on its share of the set,
+ * pinned to a processor of its own if the host has enough spare ones.
+ * Otherwise the cores, being independent, are run one after another.
+ * Off (1) by default: it multiplies the runs of every invocation.
+ */
+#define FIXT_PARTITION_CORES 1
+
+/**
+ * When above 1, fixt_test also runs every set under each global algo: one
+ * ready queue whose top jobs run on this many cores, free to migrate. Global
+ * runs carry on past deadline misses and report their tardiness, so they
+ * can be compared against the partitioned runs on as many cores.
+ */
+#define FIXT_GLOBAL_CORES FIXT_PARTITION_CORES
+
+/**
+ * When set, fixt_test also runs every set under DL, which leaves EDF to the
+ * kernel's SCHED_DEADLINE class instead of preempting from the scheduler
+ * thread, for comparison with EDF. Its task threads run outside of any
+ * processor pinning, so its pairs are tested one at a time after the
+ * others. Only Linux has such a class, and simulated runs can't use it.
+ */
+#if defined(__linux__) && !FIXT_SIMULATE
+#define FIXT_KERNEL_EDF 1
+#else
+#define FIXT_KERNEL_EDF 0
+#endif
+
+/**
+ * Task threads are taken from a pool which outlives the runs, so switching
+ * task sets creates no threads. This many are started up front, enough for
+ * the largest set on every processor; the pool grows if more are needed.
+ */
+#define FIXT_POOL_THREADS 64
+
+/**
+ * How fixt_test uses the offline schedulability analysis of each algorithm:
+ *  0 - threaded runs only
+ *  1 - threaded runs, cross-checked against the analysis
+ *  2 - analysis only; threaded runs are skipped when a verdict is known
+ */
+#define FIXT_ANALYSIS_MODE 1
+
+/**
+ * When set, each (algo, set) pair streams its k_log events to a binary trace
+ * file in FIXT_TRACE_DIR, rather than keeping them for the CSV. Traces of
+ * any length can be read back with "qnx-scheduling analyze <file>".
+ */
+#define FIXT_TRACE_FILES 0
+#define FIXT_TRACE_DIR "/tmp"
+
 /*
  * Initialize the test fixture (globally).
  */
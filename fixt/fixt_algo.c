@@ -7,116 +7,524 @@
 
 #include <semaphore.h>
 #include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 #include "utlist.h"
 #include "fixt_task.h"
+#include "fixt_set.h"
 #include "fixt_hook.h"
 #include "fixt_algo.h"
+#include "fixt_algo_static.h"
+#include "fixt_cpu.h"
 #include "spin/spin.h"
+#include "plat/plat.h"
 
 #include "log/log.h"
 #include "log/kernel_trace.h"
+#include "log/histogram.h"
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
+/*
+ * Leave every core of a global algo without a job.
+ */
+static void fixt_algo_clear_cores(struct fixt_algo* algo)
+{
+	int k;
+	for (k = 0; k < FIXT_CPU_MAX; k++) {
+		algo->al_dispatch[k] = NULL;
+		algo->al_core_running[k] = NULL;
+	}
+}
+
+/*
+ * Time on the clock a run's latencies are measured by, in ns since the run's
+ * quantum 0 on a simulated run.
+ */
+static long long fixt_algo_clock(struct fixt_algo* algo)
+{
+	return algo->al_simulated ? algo->al_clock_ns : k_log_hist_now();
+}
+
+/*
+ * Processor that core k of a global algo is pinned to.
+ */
+static int fixt_algo_core_cpu(struct fixt_algo* algo, int k)
+{
+	return algo->al_cpu == FIXT_CPU_ANY ? FIXT_CPU_ANY : algo->al_cpu + k;
+}
+
 struct fixt_algo* fixt_algo_new(AlgoHook i, AlgoHook s, AlgoHook b, AlgoHook r,
-		int policy)
+		AlgoKey k, int policy)
 {
 	struct fixt_algo* algo = malloc(sizeof(*algo));
+	algo->al_name = "custom"; /* Implementations name themselves */
 	algo->al_init = i;
 	algo->al_schedule = s;
 	algo->al_block = b;
 	algo->al_recalc = r;
+	algo->al_key = k;
+	algo->al_analyze = NULL; /* Implementations opt in after creation */
+	algo->al_step = NULL; /* Built-in implementations opt in likewise */
+	algo->al_routine = NULL;
 
 	algo->al_preferred_policy = policy;
 
-	algo->al_tasks_head = NULL;
+	algo->al_schedulable = true;
+	algo->al_soft = false;
+
+	algo->al_simulated = false;
+	algo->al_clock_ns = 0;
+
+	algo->al_now = 0;
+
+	algo->al_cpu = FIXT_CPU_ANY;
+	algo->al_cores = 1;
+
+	algo->al_jobs = 0;
+	algo->al_tardiness = 0;
+	algo->al_migrations = 0;
+	algo->al_preemptions = 0;
+
+	algo->al_phase = calloc(FIXT_PHASES, sizeof(struct k_log_hist));
+	algo->al_response = NULL; /* One per task, once a set is loaded */
+	algo->al_epoch_ns = 0;
+
+	algo->al_tasks = NULL;
+	algo->al_ntasks = 0;
+	fixt_heap_init(&algo->al_ready, 1, tk_ready);
+	fixt_heap_init(&algo->al_slack, 1, tk_slack);
+	fixt_wheel_init(&algo->al_calendar, 0);
 	algo->al_queue_head = NULL;
+	algo->al_running = NULL;
+	fixt_algo_clear_cores(algo);
 
 	return algo;
 }
 
 void fixt_algo_del(struct fixt_algo* algo)
 {
-	struct fixt_task *elt, *tmp;
-	DL_FOREACH_SAFE2(algo->al_tasks_head, elt, tmp, _at_next) {
-		DL_DELETE2(algo->al_tasks_head, elt, _at_prev, _at_next);
-		/* fixt should manage task lifetimes */
-	}
-	DL_FOREACH_SAFE2(algo->al_queue_head, elt, tmp, _aq_next) {
-		DL_DELETE2(algo->al_queue_head, elt, _aq_prev, _aq_next);
-		/* fixt should manage task lifetimes */
-	}
+	/* fixt should manage task lifetimes */
+	fixt_heap_free(&algo->al_ready);
+	fixt_heap_free(&algo->al_slack);
+	free(algo->al_phase);
+	free(algo->al_response);
 	free(algo);
 }
 
-void fixt_algo_add_task(struct fixt_algo* algo, struct fixt_task* task)
+struct fixt_algo* fixt_algo_clone(struct fixt_algo* algo)
+{
+	struct fixt_algo* copy = fixt_algo_new(algo->al_init, algo->al_schedule,
+			algo->al_block, algo->al_recalc, algo->al_key,
+			algo->al_preferred_policy);
+	copy->al_name = algo->al_name;
+	copy->al_analyze = algo->al_analyze;
+	copy->al_step = algo->al_step;
+	copy->al_routine = algo->al_routine;
+	copy->al_soft = algo->al_soft;
+	copy->al_cores = algo->al_cores;
+
+	return copy;
+}
+
+enum fixt_verdict fixt_algo_analyze(struct fixt_algo* algo,
+		struct fixt_set* set)
 {
-	DL_APPEND2(algo->al_tasks_head, task, _at_prev, _at_next);
+	if (!algo->al_analyze) return FIXT_VERDICT_UNKNOWN;
+	return algo->al_analyze(set);
 }
 
-/**
- * BAD - DO NOT USE!
- * Concat is only meant to concatenate two disjoint lists within the
- * same "list namespace"
+void fixt_algo_load(struct fixt_algo* algo, struct fixt_set* set)
+{
+	algo->al_tasks = set->ts_tasks;
+	algo->al_ntasks = set->ts_count;
+}
+
+/*
+ * Reads the virtual clock of a simulated algo on behalf of kernel_trace.
+ */
+static void fixt_algo_sim_clock(void* ctx, struct timespec* ts)
+{
+	struct fixt_algo* algo = (struct fixt_algo*) ctx;
+	ts->tv_sec = algo->al_clock_ns / 1000000000;
+	ts->tv_nsec = algo->al_clock_ns % 1000000000;
+}
+
+/*
+ * Pass the given number of quanta on the virtual clock.
  */
-void fixt_algo_copy_all(struct fixt_algo* algo, struct fixt_task* task)
+static void fixt_algo_sim_elapse(struct fixt_algo* algo, int quanta)
+{
+	algo->al_clock_ns += (long long) quanta * SPIN_QUANTUM_WIDTH_MS * 1000000;
+}
+
+void fixt_algo_simulate(struct fixt_algo* algo, bool simulated)
+{
+	algo->al_simulated = simulated;
+}
+
+void fixt_algo_pin(struct fixt_algo* algo, int cpu)
+{
+	algo->al_cpu = cpu;
+}
+
+void fixt_algo_global(struct fixt_algo* algo, int cores)
+{
+	algo->al_cores = MAX(1, MIN(cores, FIXT_CPU_MAX));
+}
+
+struct fixt_algo* fixt_algo_global_new(AlgoKey key, int cores)
+{
+	AlgoHook al_init = &fixt_algo_global_init;
+	AlgoHook al_schedule = &fixt_algo_global_schedule;
+	AlgoHook al_block = &fixt_algo_global_block;
+	AlgoHook al_recalc = &fixt_algo_global_recalc;
+
+	struct fixt_algo* algo = fixt_algo_new(al_init, al_schedule, al_block,
+			al_recalc, key, SCHED_FIFO);
+	fixt_algo_global(algo, cores);
+	algo->al_soft = true; /* Global algos have bounded tardiness; measure it */
+
+	return algo;
+}
+
+void fixt_algo_global_init(struct fixt_algo* algo)
 {
-	DL_CONCAT2(algo->al_tasks_head, task, _at_prev, _at_next);
+	plat_thread_policy(pthread_self(), SCHED_FIFO);
+}
+
+void fixt_algo_global_schedule(struct fixt_algo* algo)
+{
+	log_func(3, "global_schedule");
+
+	/* Released tasks are kept in the ready queue by recalc */
+	fixt_algo_dispatch(algo);
+
+	log_fend(3, "global_schedule");
+}
+
+void fixt_algo_global_block(struct fixt_algo* algo)
+{
+	log_func(3, "global_block");
+
+	fixt_algo_wait_all(algo, FIXT_ALGO_GLOBAL_PERIOD, FIXT_ALGO_GLOBAL_JITTER);
+
+	log_fend(3, "global_block");
+}
+
+void fixt_algo_global_recalc(struct fixt_algo* algo)
+{
+	fixt_algo_global_recalc_by(algo, algo->al_key);
 }
 
 void fixt_algo_init(struct fixt_algo* algo)
 {
 	log_func(2, "fixt_algo_init");
 
-	/* Change the main fixture thread's priority to the user max! */
-	pthread_t self = pthread_self();
-	pthread_setschedprio(self, FIXT_ALGO_BASE_PRIO);
+	/* Task threads follow the scheduler onto its processor and trace */
+	struct fixt_task* elt;
+	int i;
+	fixt_cpu_pin(algo->al_cpu);
+	for (i = 0; i < algo->al_ntasks; i++) {
+		elt = &algo->al_tasks[i];
+		elt->tk_cpu = algo->al_cpu;
+		elt->tk_trace = k_log_csv_current();
+		fixt_task_set_routine(elt, algo->al_routine);
+	}
+
+	if (algo->al_simulated) {
+		/* No threads: tasks are advanced by fixt_algo_wait() instead */
+		algo->al_clock_ns = 0;
+		k_log_set_clock(&fixt_algo_sim_clock, algo);
+		for (i = 0; i < algo->al_ntasks; i++) {
+			fixt_task_reset(&algo->al_tasks[i]);
+		}
+	} else {
+		/* Change the main fixture thread's policy to fit the algo */
+		algo->al_init(algo);
+
+		/*
+		 * Then its priority to the user max! Not before: Linux refuses a
+		 * real-time priority to a thread still under SCHED_OTHER, and a
+		 * scheduler below its own tasks could never preempt them
+		 */
+		int err = pthread_setschedprio(pthread_self(), FIXT_ALGO_BASE_PRIO);
+		if (err) {
+			fprintf(stderr, " [ fixt_algo ] scheduler priority %d: %s\n",
+					FIXT_ALGO_BASE_PRIO, strerror(err));
+		}
 
-	/* Change the main fixture thread's policy to fit the algo */
-	algo->al_init(algo);
+		/* Start up all component threads with the right policy choice */
+		for (i = 0; i < algo->al_ntasks; i++) {
+			fixt_task_run(&algo->al_tasks[i], algo->al_preferred_policy,
+					FIXT_ALGO_BASE_PRIO - 1);
+		}
+	}
 
-	/* Start up all component threads with the right policy choice */
-	struct fixt_task* elt;
-	DL_FOREACH2(algo->al_tasks_head, elt, _at_next) {
-		fixt_task_run(elt, algo->al_preferred_policy, FIXT_ALGO_BASE_PRIO - 1);
+	/* Every task starts out ready, so seed the ready queue with all of them */
+	algo->al_now = 0;
+	algo->al_schedulable = true;
+	algo->al_jobs = 0;
+	algo->al_tardiness = 0;
+	algo->al_migrations = 0;
+	algo->al_preemptions = 0;
+	algo->al_queue_head = NULL;
+	algo->al_running = NULL;
+	fixt_algo_clear_cores(algo);
+	fixt_heap_clear(&algo->al_ready);
+	fixt_heap_clear(&algo->al_slack);
+	fixt_wheel_clear(&algo->al_calendar, 0);
+	for (i = 0; i < algo->al_ntasks; i++) {
+		fixt_algo_requeue(algo, &algo->al_tasks[i]);
+	}
+
+	/* Latencies are kept per run, and tasks' are measured from here on */
+	for (i = 0; i < FIXT_PHASES; i++) {
+		k_log_hist_clear(&algo->al_phase[i]);
+	}
+	free(algo->al_response);
+	algo->al_response = calloc(algo->al_ntasks ? algo->al_ntasks : 1,
+			sizeof(struct k_log_hist));
+	algo->al_epoch_ns = fixt_algo_clock(algo);
+	for (i = 0; i < algo->al_ntasks; i++) {
+		elt = &algo->al_tasks[i];
+		elt->tk_response = &algo->al_response[i];
+		fixt_task_stamp(elt, algo->al_epoch_ns);
 	}
 
 	log_fend(2, "fixt_algo_init");
 }
 
+/*
+ * Slack check of a global algo: every dispatched job runs next, so it only
+ * needs its latest start not to have passed, while every other job loses a
+ * quantum. Dispatched jobs step out of the min-slack heap so that the
+ * tightest of the others is on top.
+ */
+static bool fixt_algo_feasible_global(struct fixt_algo* algo)
+{
+	bool schedulable = true;
+	struct fixt_task* task;
+	int k;
+	for (k = 0; k < algo->al_cores; k++) {
+		task = algo->al_dispatch[k];
+		if (!task) continue;
+		schedulable &= (fixt_heap_key(&algo->al_slack, task) >= algo->al_now);
+		fixt_heap_remove(&algo->al_slack, task);
+	}
+
+	task = fixt_heap_peek(&algo->al_slack);
+	if (task) {
+		schedulable &= (fixt_heap_key(&algo->al_slack, task) > algo->al_now);
+	}
+
+	for (k = 0; k < algo->al_cores; k++) {
+		task = algo->al_dispatch[k];
+		if (!task) continue;
+		fixt_heap_push(&algo->al_slack, task, fixt_task_latest_start(task));
+	}
+	return schedulable;
+}
+
 void fixt_algo_schedule(struct fixt_algo* algo)
 {
 	log_func(2, "fixt_algo_schedule");
 
 	k_log_s(LOG_K_ALGO);
 	/* Defer scheduling to implementation */
+	long long begin = k_log_hist_now();
 	algo->al_schedule(algo);
-
-	/* See if our queue is schedulable */
-	struct fixt_task* elt;
-	bool schedulable = true;
-	int avail_c;
-	DL_FOREACH2(algo->al_queue_head, elt, _aq_next) {
-		/* The time available until deadline if elt was run next */
-		avail_c = fixt_task_remaining_time(elt);
-		if(elt == algo->al_queue_head) {
-			/* If elt is the head, then we can Indiana Jones our tk_c */
-			schedulable &= (fixt_task_completion_time(elt) <= avail_c);
-		} else {
-			/* Otherwise, elt won't have avail_c next iteration */
-			schedulable &= (fixt_task_completion_time(elt) < avail_c);
-		}
-	}
-	algo->al_schedulable = schedulable;
+	fixt_algo_check(algo);
+	k_log_hist_add(&algo->al_phase[FIXT_PHASE_SCHEDULE],
+			k_log_hist_now() - begin);
 	k_log_e(LOG_K_ALGO);
 
 	log_fend(2, "fixt_algo_schedule");
 }
 
+void fixt_algo_check(struct fixt_algo* algo)
+{
+	/*
+	 * See if our queue is schedulable. A ready task can still make its
+	 * deadline as long as its latest start time (deadline minus remaining
+	 * execution) hasn't passed. Requeue keeps those in the min-slack heap,
+	 * so only the jobs about to run and the tightest other task need
+	 * checking. A miss sticks for the rest of the run.
+	 */
+	bool schedulable;
+	if (algo->al_cores > 1) {
+		schedulable = fixt_algo_feasible_global(algo);
+	} else {
+		struct fixt_task* head = algo->al_queue_head;
+		struct fixt_task* tight = fixt_heap_peek_except(&algo->al_slack, head);
+		schedulable = true;
+		if (head) {
+			/* The head runs next, so it can Indiana Jones its tk_c */
+			schedulable &= (fixt_heap_key(&algo->al_slack, head)
+					>= algo->al_now);
+		}
+		if (tight) {
+			/* Other tasks lose a quantum of slack before they can run */
+			schedulable &= (fixt_heap_key(&algo->al_slack, tight)
+					> algo->al_now);
+		}
+	}
+	algo->al_schedulable &= schedulable;
+}
+
+void fixt_algo_dispatch(struct fixt_algo* algo)
+{
+	int m = algo->al_cores;
+	int n, i, k;
+
+	/* Pop the top m jobs off the ready queue, then put them back */
+	struct fixt_task* top[FIXT_CPU_MAX];
+	int key[FIXT_CPU_MAX];
+	for (n = 0; n < m; n++) {
+		top[n] = fixt_heap_peek(&algo->al_ready);
+		if (!top[n]) break;
+		key[n] = fixt_heap_key(&algo->al_ready, top[n]);
+		fixt_heap_remove(&algo->al_ready, top[n]);
+	}
+	for (i = 0; i < n; i++) {
+		fixt_heap_push(&algo->al_ready, top[i], key[i]);
+	}
+
+	/* Jobs still among the top m stay put; the others are preempted */
+	struct fixt_task* next[FIXT_CPU_MAX];
+	bool placed[FIXT_CPU_MAX];
+	for (k = 0; k < m; k++) {
+		next[k] = NULL;
+		placed[k] = false;
+	}
+	for (k = 0; k < m; k++) {
+		struct fixt_task* prev = algo->al_dispatch[k];
+		if (!prev) continue;
+		for (i = 0; i < n && top[i] != prev; i++)
+			;
+		if (i < n) {
+			next[k] = prev;
+			placed[i] = true;
+		} else if (fixt_task_already_executing(prev)) {
+			algo->al_preemptions++;
+		}
+	}
+
+	/* Newly dispatched jobs go back to their last core if it is free */
+	for (i = 0; i < n; i++) {
+		if (placed[i]) continue;
+		struct fixt_task* task = top[i];
+		k = task->tk_core;
+		if (k < 0 || k >= m || next[k]) {
+			for (k = 0; next[k]; k++)
+				;
+		}
+		if (fixt_task_already_executing(task) && task->tk_core != k) {
+			algo->al_migrations++;
+		}
+		task->tk_core = k;
+		next[k] = task;
+	}
+
+	for (k = 0; k < m; k++) {
+		algo->al_dispatch[k] = next[k];
+	}
+	algo->al_queue_head = n ? top[0] : NULL;
+}
+
+void fixt_algo_requeue(struct fixt_algo* algo, struct fixt_task* task)
+{
+	fixt_algo_requeue_by(algo, task, algo->al_key);
+}
+
+void fixt_algo_retire(struct fixt_algo* algo, struct fixt_task* task,
+		int end)
+{
+	algo->al_jobs++;
+	algo->al_tardiness += MAX(0, end - fixt_task_get_deadline(task));
+	fixt_task_next_job(task);
+
+	/* A job due already stays queued, so it isn't released by a requeue */
+	if (fixt_task_get_release(task) <= algo->al_now) {
+		k_log_s(LOG_K_ARRIVAL + task->tk_id);
+	}
+}
+
+void fixt_algo_advance(struct fixt_algo* algo, int delta)
+{
+	fixt_algo_advance_by(algo, delta, algo->al_key);
+}
+
 /*
- * Release the head task by posting its semaphore. Then, block the
+ * Release the head of a uniprocessor algo.
+ */
+static void fixt_algo_release_head(struct fixt_algo* algo)
+{
+	/*
+	 * Only the head may run while the scheduler is blocked. Every other
+	 * thread sits at the minimum priority, so the only reprioritization
+	 * needed is swapping the previous head out for the new one.
+	 */
+	struct fixt_task* head = algo->al_queue_head;
+	if (head != algo->al_running && !algo->al_simulated) {
+		if (algo->al_running) {
+			fixt_task_set_prio(algo->al_running, FIXT_ALGO_MIN_PRIO);
+		}
+		fixt_task_set_prio(head, FIXT_ALGO_BASE_PRIO - 1);
+	}
+	algo->al_running = head;
+
+	/*
+	 * Release the head task for execution if it needs to be started.
+	 * Can't peek at the handoff count here to determine if a task is waiting or
+	 * executing, because tasks lose the CPU at the bottom of their loop
+	 * (before they can wait again). This was a nasty bug
+	 */
+	if(!fixt_task_already_executing(head) && !algo->al_simulated) {
+		fixt_handoff_post(fixt_task_get_cont(head));
+	}
+}
+
+/*
+ * Release every dispatched job of a global algo on its core. As on one
+ * processor, jobs without a core sit at the minimum priority, so each core
+ * runs only the job released there. Displaced jobs are demoted before their
+ * successors are promoted, and a job that changed cores is moved to the new
+ * processor first.
+ */
+static void fixt_algo_release_all(struct fixt_algo* algo)
+{
+	struct fixt_task* task;
+	int k;
+	for (k = 0; k < algo->al_cores; k++) {
+		task = algo->al_core_running[k];
+		if (task && algo->al_dispatch[task->tk_core] != task
+				&& !algo->al_simulated) {
+			fixt_task_set_prio(task, FIXT_ALGO_MIN_PRIO);
+		}
+	}
+
+	for (k = 0; k < algo->al_cores; k++) {
+		task = algo->al_dispatch[k];
+		if (task && task != algo->al_core_running[k] && !algo->al_simulated) {
+			fixt_cpu_pin_thread(task->tk_thread, fixt_algo_core_cpu(algo, k));
+			fixt_task_set_prio(task, FIXT_ALGO_BASE_PRIO - 1);
+		}
+		algo->al_core_running[k] = task;
+
+		if (task && !fixt_task_already_executing(task)
+				&& !algo->al_simulated) {
+			fixt_handoff_post(fixt_task_get_cont(task));
+		}
+	}
+}
+
+/*
+ * Release the head task by posting its handoff. Then, block the
  * scheduling thread (this thread) so that the the head task may run.
  *
  * Return from al_block() at the time specified by algorithm specific
@@ -127,62 +535,224 @@ void fixt_algo_run(struct fixt_algo* algo)
 {
 	log_func(2, "fixt_algo_run");
 
-	/* If no task needs to run, spin the scheduler until one is ready */
 	if (!algo->al_queue_head) {
 		log_msg(3, "[ Null Queue Head ]");
-		spin_for(fixt_algo_min_r(algo));
+		fixt_algo_idle(algo);
 	} else {
 		log_msg(3, "[ Non-Null Queue Head ]");
+		fixt_algo_release(algo);
+		algo->al_block(algo);
+	}
 
-		k_log_s(LOG_K_ALGO);
-		/* Reprioritize all threads according to the queue ordering */
-		struct fixt_task* elt;
-		int prio = FIXT_ALGO_BASE_PRIO;
-		DL_FOREACH2(algo->al_queue_head, elt, _aq_next) {
-			prio--; /* In descending order */
-			fixt_task_set_prio(elt, MAX(prio, FIXT_ALGO_MIN_PRIO));
-		}
+	k_log_s(LOG_K_RECALC);
+	long long begin = k_log_hist_now();
+	algo->al_recalc(algo);
+	k_log_hist_add(&algo->al_phase[FIXT_PHASE_RECALC],
+			k_log_hist_now() - begin);
+	k_log_e(LOG_K_RECALC);
+
+	log_fend(2, "fixt_algo_run");
+}
+
+void fixt_algo_release(struct fixt_algo* algo)
+{
+	k_log_s(LOG_K_RELEASE);
+	long long begin = k_log_hist_now();
+	if (algo->al_cores > 1) {
+		fixt_algo_release_all(algo);
+	} else {
+		fixt_algo_release_head(algo);
+	}
+	k_log_hist_add(&algo->al_phase[FIXT_PHASE_RELEASE],
+			k_log_hist_now() - begin);
+	k_log_e(LOG_K_RELEASE);
+}
+
+void fixt_algo_idle(struct fixt_algo* algo)
+{
+	/* If no task needs to run, spin the scheduler until one is ready */
+	if (algo->al_simulated) {
+		fixt_algo_sim_elapse(algo, fixt_algo_min_r(algo));
+	} else {
+		spin_for(fixt_algo_min_r(algo));
+	}
+}
+
+void fixt_algo_step(struct fixt_algo* algo)
+{
+	if (algo->al_step) {
+		algo->al_step(algo);
+		return;
+	}
+
+	fixt_algo_schedule(algo);
+	if (algo->al_schedulable || algo->al_soft) {
+		fixt_algo_run(algo);
+	}
+}
+
+/*
+ * Record how long after the given CLOCK_REALTIME time a timed block woke.
+ */
+static void fixt_algo_overshoot(struct fixt_algo* algo,
+		const struct timespec* wake)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	k_log_hist_add(&algo->al_phase[FIXT_PHASE_OVERSHOOT],
+			(now.tv_sec - wake->tv_sec) * 1000000000LL
+			+ (now.tv_nsec - wake->tv_nsec));
+}
+
+bool fixt_algo_wait(struct fixt_algo* algo, int quanta, long jitter_ns)
+{
+	struct fixt_task* head = algo->al_queue_head;
 
+	if (algo->al_simulated) {
 		/*
-		 * Release the head task for execution if it needs to be started.
-		 * Can't use sem_getvalue() here to determine if a task is waiting or
-		 * executing, because tasks lose the CPU at the bottom of their loop
-		 * (before they can sem_wait again). This was a nasty bug
+		 * Play the head's thread: it logs the start of a fresh job, runs
+		 * until done or preempted, and logs the end of the job if done.
 		 */
-		if(!fixt_task_already_executing(algo->al_queue_head)) {
-			sem_post(fixt_task_get_sem_cont(algo->al_queue_head));
+		int left = fixt_task_completion_time(head);
+		bool done = (quanta == FIXT_ALGO_WAIT_FOREVER || left <= quanta);
+
+		if (!fixt_task_already_executing(head)) k_log_s(head->tk_id);
+		fixt_algo_sim_elapse(algo, done ? left : quanta);
+		if (done) {
+			k_log_e(head->tk_id);
+			fixt_task_complete(head, head->tk_release_ns,
+					head->tk_deadline_ns, algo->al_clock_ns);
 		}
-		k_log_e(LOG_K_ALGO);
 
-		algo->al_block(algo);
+		return done;
 	}
 
-	k_log_s(LOG_K_ALGO);
-	algo->al_recalc(algo);
-	k_log_e(LOG_K_ALGO);
+	struct fixt_handoff* done = fixt_task_get_done(head);
+	if (quanta == FIXT_ALGO_WAIT_FOREVER) {
+		fixt_handoff_wait(done);
+		return true;
+	}
 
-	log_fend(2, "fixt_algo_run");
+	struct timespec abs_next;
+	abs_next = spin_abstime_in_quanta(quanta, jitter_ns);
+	if (fixt_handoff_timedwait(done, &abs_next)) return true;
+
+	fixt_algo_overshoot(algo, &abs_next);
+	return false;
+}
+
+void fixt_algo_wait_all(struct fixt_algo* algo, int quanta, long jitter_ns)
+{
+	struct fixt_task* task;
+	int k;
+
+	if (algo->al_simulated) {
+		/* Play every dispatched thread side by side, as fixt_algo_wait() */
+		for (k = 0; k < algo->al_cores; k++) {
+			task = algo->al_dispatch[k];
+			if (task && !fixt_task_already_executing(task)) {
+				k_log_s(task->tk_id);
+			}
+		}
+		fixt_algo_sim_elapse(algo, quanta);
+		for (k = 0; k < algo->al_cores; k++) {
+			task = algo->al_dispatch[k];
+			if (task && fixt_task_completion_time(task) <= quanta) {
+				k_log_e(task->tk_id);
+				fixt_task_complete(task, task->tk_release_ns,
+						task->tk_deadline_ns, algo->al_clock_ns);
+			}
+		}
+		return;
+	}
+
+	/* Cores are not handed over early, so simply sleep out the quanta */
+	struct timespec abs_next;
+	abs_next = spin_abstime_in_quanta(quanta, jitter_ns);
+	while (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &abs_next, NULL)
+			== EINTR)
+		;
+	fixt_algo_overshoot(algo, &abs_next);
+
+	/* Soak up completions so done never runs ahead of the bookkeeping */
+	for (k = 0; k < algo->al_cores; k++) {
+		task = algo->al_dispatch[k];
+		if (!task) continue;
+		while (fixt_handoff_trywait(fixt_task_get_done(task)))
+			;
+	}
 }
 
 int fixt_algo_min_r(struct fixt_algo* algo)
 {
-	int r = INT_MAX;
-	struct fixt_task* elt;
-	DL_FOREACH2(algo->al_tasks_head, elt, _at_next) {
-		r = MIN(r, elt->tk_r);
+	int next = fixt_wheel_next(&algo->al_calendar);
+	return next == INT_MAX ? INT_MAX : next - algo->al_now;
+}
+
+void fixt_algo_report(struct fixt_algo* algo)
+{
+	static const char* phases[FIXT_PHASES] = {
+		"schedule", "release", "block overshoot", "recalc"
+	};
+
+	/* Runs on other processors report at the same time; keep lines apart */
+	char name[64];
+	int i, misses = 0;
+	flockfile(stdout);
+	for (i = 0; i < FIXT_PHASES; i++) {
+		snprintf(name, sizeof(name), "%s %s", algo->al_name, phases[i]);
+		k_log_hist_print(name, &algo->al_phase[i]);
+	}
+	for (i = 0; i < algo->al_ntasks; i++) {
+		struct fixt_task* task = &algo->al_tasks[i];
+		snprintf(name, sizeof(name), "%s TASK %d response", algo->al_name,
+				task->tk_id);
+		k_log_hist_print(name, &algo->al_response[i]);
+		printf(" [ DEADLINE %s TASK %d ] jobs %llu misses %d "
+				"tardiness us %.1f\n", algo->al_name, task->tk_id,
+				(unsigned long long) algo->al_response[i].kh_total,
+				task->tk_misses, task->tk_tardiness_ns / 1000.0);
+		misses += task->tk_misses;
 	}
-	return r;
+
+	/* Calibration drift and overhead show up here, not in al_schedulable */
+	if (misses && algo->al_schedulable) {
+		printf(" [ DEADLINE %s ] %d misses on the clock the model did not "
+				"predict\n", algo->al_name, misses);
+	}
+	funlockfile(stdout);
+}
+
+int fixt_algo_misses(struct fixt_algo* algo, long long* late_ns)
+{
+	int i, misses = 0;
+	*late_ns = 0;
+	for (i = 0; i < algo->al_ntasks; i++) {
+		misses += algo->al_tasks[i].tk_misses;
+		*late_ns += algo->al_tasks[i].tk_tardiness_ns;
+	}
+	return misses;
 }
 
 void fixt_algo_halt(struct fixt_algo* algo)
 {
 	log_func(2, "fixt_algo_halt");
 
-	struct fixt_task *elt, *tmp;
-	DL_FOREACH_SAFE2(algo->al_tasks_head, elt, tmp, _at_next) {
-		fixt_task_stop(elt);
-		DL_DELETE2(algo->al_tasks_head, elt, _at_prev, _at_next);
+	int i;
+	if (!algo->al_simulated) {
+		for (i = 0; i < algo->al_ntasks; i++) {
+			fixt_task_stop(&algo->al_tasks[i]);
+		}
+	}
+	if (algo->al_simulated) {
+		k_log_set_clock(NULL, NULL);
 	}
+	fixt_heap_clear(&algo->al_ready);
+	fixt_heap_clear(&algo->al_slack);
+	fixt_wheel_clear(&algo->al_calendar, 0);
+	algo->al_queue_head = NULL;
+	algo->al_running = NULL;
+	fixt_algo_clear_cores(algo);
 
 	log_fend(2, "fixt_algo_halt");
 }
@@ -11,24 +11,81 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include "fixt_hook.h"
+#include "fixt_heap.h"
+#include "fixt_wheel.h"
+#include "fixt_cpu.h"
+#include "log/histogram.h"
 
 #define FIXT_ALGO_BASE_PRIO 10 /* qconn port=8000 qconn_prio=10 */
 #define FIXT_ALGO_MIN_PRIO 7
+#define FIXT_ALGO_WAIT_FOREVER -1 /* fixt_algo_wait() until the head is done */
+
+/*
+ * Give each built-in implementation a step function specialized at compile
+ * time (see fixt_algo_static.h). Set to 0 to run every algo through its hooks.
+ */
+#ifndef FIXT_ALGO_STATIC_DISPATCH
+#define FIXT_ALGO_STATIC_DISPATCH 1
+#endif
+
 struct fixt_task;
 
+/*
+ * Parts of a scheduling decision whose latency each run keeps a histogram of
+ */
+enum fixt_algo_phase
+{
+	FIXT_PHASE_SCHEDULE, /* fixt_algo_schedule(): the al_schedule hook */
+	FIXT_PHASE_RELEASE, /* fixt_algo_release(): reprioritizing threads */
+	FIXT_PHASE_OVERSHOOT, /* How late a timed al_block woke past its time */
+	FIXT_PHASE_RECALC, /* The al_recalc hook */
+	FIXT_PHASES
+};
+
 struct fixt_algo
 {
+	const char* al_name; /* Short name used in traces */
+
 	AlgoHook al_init; /* Hook run to set the scheduler thread's policy */
 	AlgoHook al_schedule; /* Hook run to organize the queue */
 	AlgoHook al_block; /* Hook which blocks until the scheduler should resume */
 	AlgoHook al_recalc; /* Hooks which updates bookeeping after a run */
+	AlgoKey al_key; /* Hook which computes a ready task's queue key */
+	AlgoVerdict al_analyze; /* Optional offline schedulability test */
+	AlgoHook al_step; /* Specialized schedule and run, or NULL to use hooks */
+	void* (*al_routine)(void*); /* Task thread body, or NULL for the usual */
 
 	int al_preferred_policy; /* Scheduling policy for all new task threads */
 
-	bool al_schedulable; /* Updated after fixt_algo_schedule() is run */
+	bool al_schedulable; /* Cleared by fixt_algo_schedule() on any miss */
+	bool al_soft; /* Keep running past deadline misses, counting tardiness */
 
-	struct fixt_task* al_tasks_head; /* List of tasks managed by this algo */
-	struct fixt_task* al_queue_head; /* Ordering of tasks at any given time */
+	bool al_simulated; /* Run against a virtual clock instead of threads */
+	long long al_clock_ns; /* Virtual clock of a simulated run */
+
+	int al_now; /* Quanta elapsed since fixt_algo_init() */
+
+	int al_cpu; /* Processor the scheduler and tasks run on, or FIXT_CPU_ANY */
+	int al_cores; /* Cores dispatched onto from al_cpu up (1: uniprocessor) */
+
+	int al_jobs; /* Jobs completed since fixt_algo_init() */
+	int al_tardiness; /* Quanta those jobs ran past their deadlines */
+	int al_migrations; /* Jobs resumed on another core than they left */
+	int al_preemptions; /* Running jobs displaced from their core */
+
+	struct k_log_hist* al_phase; /* FIXT_PHASES histograms of this run */
+	struct k_log_hist* al_response; /* Release to completion, per task */
+	long long al_epoch_ns; /* k_log_hist_now() of quantum 0 */
+
+	struct fixt_task* al_tasks; /* Table of tasks managed by this algo */
+	int al_ntasks; /* Number of tasks in al_tasks */
+	struct fixt_heap al_ready; /* Ready tasks ordered by al_key */
+	struct fixt_heap al_slack; /* Ready tasks ordered by latest start time */
+	struct fixt_wheel al_calendar; /* Tasks waiting on their next release */
+	struct fixt_task* al_queue_head; /* Top of al_ready chosen to run next */
+	struct fixt_task* al_running; /* Task last released at high priority */
+	struct fixt_task* al_dispatch[FIXT_CPU_MAX]; /* Job chosen for each core */
+	struct fixt_task* al_core_running[FIXT_CPU_MAX]; /* Job released there */
 
 	/* For private use by utlist.h */
 	struct fixt_algo* prev;
@@ -37,22 +94,95 @@ struct fixt_algo
 
 /*
  * Create a new scheduling algorithm given the four implementation-specific
- * hooks and a preferred scheduling policy for all task threads.
+ * hooks, the ready queue key and a preferred scheduling policy for all task
+ * threads.
  */
-struct fixt_algo* fixt_algo_new(AlgoHook, AlgoHook, AlgoHook, AlgoHook, int policy);
+struct fixt_algo* fixt_algo_new(AlgoHook, AlgoHook, AlgoHook, AlgoHook,
+		AlgoKey, int policy);
 void fixt_algo_del(struct fixt_algo*);
 
 /*
- * Add a single task to the algorithms' accounting.
+ * Create a fresh algorithm with the same hooks, policy and cores, but none of
+ * the run state. Lets the same algorithm be tested on several sets at once.
  */
-void fixt_algo_add_task(struct fixt_algo*, struct fixt_task*);
+struct fixt_algo* fixt_algo_clone(struct fixt_algo*);
 
-/**
- * BAD - DO NOT USE!
- * Concat is only meant to concatenate two disjoint lists within the
- * same "list namespace"
+/*
+ * Decide offline whether a task set is schedulable by this algorithm.
+ * Returns FIXT_VERDICT_UNKNOWN if the algorithm has no analysis.
  */
-void fixt_algo_copy_all(struct fixt_algo*, struct fixt_task*);
+enum fixt_verdict fixt_algo_analyze(struct fixt_algo*, struct fixt_set*);
+
+/*
+ * Take on every task of a set. The algo works on the set's own task table,
+ * so the set must outlive the run and not be run by another algo at once.
+ */
+void fixt_algo_load(struct fixt_algo*, struct fixt_set*);
+
+/*
+ * Choose between running tasks as real threads (the default) and a
+ * thread-free discrete-event simulation. Simulated runs go through the same
+ * hooks and produce the same decisions and k_log stream, but time only
+ * passes on a virtual clock. Must be set before fixt_algo_init().
+ */
+void fixt_algo_simulate(struct fixt_algo*, bool simulated);
+
+/*
+ * Pin the scheduler (the thread calling fixt_algo_init()) and every task
+ * thread to a single processor, so that the run neither disturbs nor is
+ * disturbed by work on other processors. Must be set before
+ * fixt_algo_init().
+ */
+void fixt_algo_pin(struct fixt_algo*, int cpu);
+
+/*
+ * Make this a global algorithm: one ready queue whose top jobs run on up to
+ * cores processors at once (al_cpu and the ones after it, if pinned), with
+ * jobs free to migrate between them. The al_schedule hook of a global
+ * algorithm calls fixt_algo_dispatch(), its al_block hook calls
+ * fixt_algo_wait_all(), and its al_recalc hook charges every job in
+ * al_dispatch, as the fixt_algo_global_*() hooks do. Must be set before
+ * fixt_algo_init().
+ */
+void fixt_algo_global(struct fixt_algo*, int cores);
+
+#define FIXT_ALGO_GLOBAL_PERIOD 1 /* Quanta between global preemptions */
+#define FIXT_ALGO_GLOBAL_JITTER 2000000 /* 2ms grace before preempting */
+
+/*
+ * Create a global algorithm on the given number of cores. Global algorithms
+ * differ only in their ready queue key: they share the hooks below, which
+ * dispatch the top jobs of the queue to the cores every
+ * FIXT_ALGO_GLOBAL_PERIOD quanta.
+ */
+struct fixt_algo* fixt_algo_global_new(AlgoKey, int cores);
+
+/*
+ * Run the fixture thread (self) and, by inheritance, all task threads under
+ * a FIFO policy. Each core only ever has one task thread above the minimum
+ * priority, the one dispatched there.
+ */
+void fixt_algo_global_init(struct fixt_algo*);
+
+/*
+ * Dispatch the top jobs of the ready queue, one to each core, preempting
+ * the lowest priority jobs which were running.
+ */
+void fixt_algo_global_schedule(struct fixt_algo*);
+
+/*
+ * Preempt user tasks every FIXT_ALGO_GLOBAL_PERIOD quanta, on every core at
+ * once.
+ */
+void fixt_algo_global_block(struct fixt_algo*);
+
+/*
+ * Advance the release calendar past the last run. Every dispatched job ran
+ * for FIXT_ALGO_GLOBAL_PERIOD quanta on its core; jobs with no execution
+ * time left are retired and charged their tardiness. If no task ran, the
+ * scheduler idled until the earliest pending release.
+ */
+void fixt_algo_global_recalc(struct fixt_algo*);
 
 /*
  * Initialize the scheduler and start component task threads.
@@ -60,10 +190,49 @@ void fixt_algo_copy_all(struct fixt_algo*, struct fixt_task*);
 void fixt_algo_init(struct fixt_algo*);
 
 /*
- * Determine which task should run next by sorting the queue.
+ * Determine which task should run next from the ready queue.
  */
 void fixt_algo_schedule(struct fixt_algo*);
 
+/*
+ * Clear al_schedulable if a ready task can no longer make its deadline.
+ * Called by fixt_algo_schedule() once the al_schedule hook has run.
+ */
+void fixt_algo_check(struct fixt_algo*);
+
+/*
+ * Fill al_dispatch with the top al_cores jobs of the ready queue. Jobs
+ * already running keep their core and the rest take the cores of the
+ * lowest priority jobs they displace, preferring the core they last ran on.
+ * al_queue_head is set to the top job, or NULL if none is ready.
+ */
+void fixt_algo_dispatch(struct fixt_algo*);
+
+/*
+ * Re-evaluate a task's place in the ready queue after its bookkeeping
+ * changed: insert it on release (logging the job's LOG_K_ARRIVAL event),
+ * remove it on completion (parking it in the release calendar until its
+ * next release), and otherwise re-key it in place. The task's slack is
+ * refreshed alongside. Called by al_recalc implementations whenever a task
+ * is released, completed or charged.
+ */
+void fixt_algo_requeue(struct fixt_algo*, struct fixt_task*);
+
+/*
+ * Retire a task's current job, which finished at the absolute quantum end,
+ * and account for it in al_jobs and al_tardiness. Logs the release of the
+ * next job if it is due already. Called by al_recalc implementations in
+ * place of fixt_task_next_job().
+ */
+void fixt_algo_retire(struct fixt_algo*, struct fixt_task*, int end);
+
+/*
+ * Move the algorithm clock forward by delta quanta and queue every task
+ * whose release time arrived in the meantime. Called by al_recalc
+ * implementations once the head's bookkeeping is up to date.
+ */
+void fixt_algo_advance(struct fixt_algo*, int delta);
+
 /*
  * Reprioritize all threads given the queue order and release the top
  * task for execution. Also, recompute internal bookeeping logic.
@@ -71,12 +240,61 @@ void fixt_algo_schedule(struct fixt_algo*);
 void fixt_algo_run(struct fixt_algo*);
 
 /*
- * Stop all component threads.
+ * Reprioritize task threads so that only the queue head (or every job in
+ * al_dispatch, if global) may run, and release it. Called by
+ * fixt_algo_run() before the al_block hook.
+ */
+void fixt_algo_release(struct fixt_algo*);
+
+/*
+ * Let time pass until the next task release. Called by fixt_algo_run() in
+ * place of releasing anything when no task is ready.
+ */
+void fixt_algo_idle(struct fixt_algo*);
+
+/*
+ * Make one scheduling decision: fixt_algo_schedule(), then fixt_algo_run()
+ * unless that cleared al_schedulable on an algo which is not al_soft. Goes
+ * through al_step if the algo has one.
+ */
+void fixt_algo_step(struct fixt_algo*);
+
+/*
+ * Let the head run until it completes or the given number of quanta (plus
+ * jitter_ns of grace) pass, whichever comes first. Pass
+ * FIXT_ALGO_WAIT_FOREVER to wait for completion. Returns true if the head
+ * completed. Called by al_block implementations.
+ */
+bool fixt_algo_wait(struct fixt_algo*, int quanta, long jitter_ns);
+
+/*
+ * Let every job in al_dispatch run for the given number of quanta (plus
+ * jitter_ns of grace). Called by the al_block hooks of global algorithms.
+ */
+void fixt_algo_wait_all(struct fixt_algo*, int quanta, long jitter_ns);
+
+/*
+ * Print the percentiles of each phase and task latency histogram of the
+ * run, and each task's deadline misses on the clock. Called once the run is
+ * over, after fixt_algo_halt() has stopped the task threads.
+ */
+void fixt_algo_report(struct fixt_algo*);
+
+/*
+ * Return the deadline misses of the run on the clock, over every task, and
+ * add up their tardiness in late_ns.
+ */
+int fixt_algo_misses(struct fixt_algo*, long long* late_ns);
+
+/*
+ * Stop all component threads. The task table stays loaded, for
+ * fixt_algo_report(), until the next fixt_algo_load().
  */
 void fixt_algo_halt(struct fixt_algo*);
 
 /*
  * Determines the minimum time until the next task becomes ready
+ * (INT_MAX if no task is waiting on a release)
  */
 int fixt_algo_min_r(struct fixt_algo*);
 
@@ -0,0 +1,178 @@
+/*
+ * File: fixt_algo_static.h
+ * Description: Compile-time specialization of the scheduler loop per algorithm
+ *
+ * A scheduling decision goes through five function pointers: al_schedule,
+ * al_block and al_recalc, plus al_key once for every task requeued. With
+ * FIXT_ALGO_STATIC_DISPATCH set, an implementation built into the tree
+ * instead gets its own step function with its hooks and key called
+ * directly, so the compiler can inline them into one body. Plugins (algos
+ * created with fixt_algo_new() alone) keep going through the hooks.
+ *
+ * An implementation opts in by defining FIXT_ALGO_STATIC_KEY as its key
+ * function before including this header. Its calls to fixt_algo_requeue()
+ * and fixt_algo_advance() then bind the key at compile time, and
+ * FIXT_ALGO_STATIC_STEP(impl) generates impl_step() from impl_schedule(),
+ * impl_block() and impl_recalc() for its constructor to set as al_step.
+ * A global algorithm, which shares its hooks with the others, uses
+ * FIXT_ALGO_STATIC_GLOBAL_STEP(impl) instead.
+ */
+
+#ifndef FIXT_ALGO_STATIC_H
+#define FIXT_ALGO_STATIC_H
+
+#include "utlist.h"
+#include "fixt_algo.h"
+#include "fixt_task.h"
+#include "fixt_heap.h"
+#include "fixt_wheel.h"
+#include "log/log.h"
+#include "log/kernel_trace.h"
+#include "log/histogram.h"
+
+/*
+ * fixt_algo_requeue() with the key function given. Called with a constant
+ * key, the key is inlined along with the rest.
+ */
+static inline void fixt_algo_requeue_by(struct fixt_algo* algo,
+		struct fixt_task* task, AlgoKey key)
+{
+	bool ready = fixt_task_get_release(task) <= algo->al_now;
+	bool queued = fixt_heap_contains(&algo->al_ready, task);
+
+	if (ready && queued) {
+		fixt_heap_rekey(&algo->al_ready, task, key(algo, task));
+		fixt_heap_rekey(&algo->al_slack, task, fixt_task_latest_start(task));
+	} else if (ready) {
+		/* A task only joins the ready queue as its job is released */
+		k_log_s(LOG_K_ARRIVAL + task->tk_id);
+		fixt_heap_push(&algo->al_ready, task, key(algo, task));
+		fixt_heap_push(&algo->al_slack, task, fixt_task_latest_start(task));
+	} else {
+		if (queued) {
+			fixt_heap_remove(&algo->al_ready, task);
+			fixt_heap_remove(&algo->al_slack, task);
+		}
+		if (!fixt_wheel_contains(task)) {
+			fixt_wheel_insert(&algo->al_calendar, task);
+		}
+	}
+}
+
+/*
+ * fixt_algo_advance() with the key function given.
+ */
+static inline void fixt_algo_advance_by(struct fixt_algo* algo, int delta,
+		AlgoKey key)
+{
+	algo->al_now += delta;
+
+	/* Only the tasks released during the last delta quanta are touched */
+	struct fixt_task *elt, *tmp;
+	struct fixt_task* released;
+	released = fixt_wheel_advance(&algo->al_calendar, algo->al_now);
+	DL_FOREACH_SAFE2(released, elt, tmp, _tw_next) {
+		log_ibef(4, elt);
+		fixt_algo_requeue_by(algo, elt, key);
+		log_iaft(4, elt);
+	}
+}
+
+/*
+ * fixt_algo_global_recalc() with the key function given.
+ */
+static inline void fixt_algo_global_recalc_by(struct fixt_algo* algo,
+		AlgoKey key)
+{
+	log_func(3, "global_recalc");
+
+	int delta; /* The number of quanta elapsed since last run */
+	if (algo->al_queue_head) {
+		/* Dispatched jobs ran side by side: Δ = scheduler period */
+		delta = FIXT_ALGO_GLOBAL_PERIOD;
+
+		int k;
+		for (k = 0; k < algo->al_cores; k++) {
+			struct fixt_task* task = algo->al_dispatch[k];
+			if (!task) continue;
+			log_hbef(4, task);
+
+			task->tk_a += delta;
+			if (fixt_task_completion_time(task) <= 0) {
+				fixt_algo_retire(algo, task, algo->al_now + delta);
+			}
+			fixt_algo_requeue_by(algo, task, key);
+
+			log_haft(4, task);
+		}
+	} else {
+		/* Skip ahead to the next release: Δ = min(ri) */
+		delta = fixt_algo_min_r(algo);
+	}
+
+	/* Tasks released during Δ join the ready queue */
+	fixt_algo_advance_by(algo, delta, key);
+
+	log_fend(3, "global_recalc");
+}
+
+/*
+ * One fixt_algo_step() made of the given schedule, block and recalc hooks:
+ * fixt_algo_schedule() then, if the algo may go on, fixt_algo_run().
+ */
+#define FIXT_ALGO_STATIC_STEP_OF(name, schedule, block, recalc) \
+static void name(struct fixt_algo* algo) \
+{ \
+	k_log_s(LOG_K_ALGO); \
+	long long begin = k_log_hist_now(); \
+	schedule(algo); \
+	fixt_algo_check(algo); \
+	k_log_hist_add(&algo->al_phase[FIXT_PHASE_SCHEDULE], \
+			k_log_hist_now() - begin); \
+	k_log_e(LOG_K_ALGO); \
+	if (!algo->al_schedulable && !algo->al_soft) return; \
+	\
+	if (algo->al_queue_head) { \
+		fixt_algo_release(algo); \
+		block(algo); \
+	} else { \
+		fixt_algo_idle(algo); \
+	} \
+	\
+	k_log_s(LOG_K_RECALC); \
+	begin = k_log_hist_now(); \
+	recalc(algo); \
+	k_log_hist_add(&algo->al_phase[FIXT_PHASE_RECALC], \
+			k_log_hist_now() - begin); \
+	k_log_e(LOG_K_RECALC); \
+}
+
+/*
+ * One fixt_algo_step() of implementation impl, with impl's hooks called
+ * directly.
+ */
+#define FIXT_ALGO_STATIC_STEP(impl) \
+	FIXT_ALGO_STATIC_STEP_OF(impl##_step, impl##_schedule, impl##_block, \
+			impl##_recalc)
+
+/*
+ * One fixt_algo_step() of global implementation impl: the shared global
+ * hooks, with impl_key() bound into the recalc.
+ */
+#define FIXT_ALGO_STATIC_GLOBAL_STEP(impl) \
+static void impl##_recalc(struct fixt_algo* algo) \
+{ \
+	fixt_algo_global_recalc_by(algo, &impl##_key); \
+} \
+FIXT_ALGO_STATIC_STEP_OF(impl##_step, fixt_algo_global_schedule, \
+		fixt_algo_global_block, impl##_recalc)
+
+#endif
+
+#if FIXT_ALGO_STATIC_DISPATCH && defined(FIXT_ALGO_STATIC_KEY) \
+		&& !defined(fixt_algo_requeue)
+#define fixt_algo_requeue(algo, task) \
+	fixt_algo_requeue_by(algo, task, &FIXT_ALGO_STATIC_KEY)
+#define fixt_algo_advance(algo, delta) \
+	fixt_algo_advance_by(algo, delta, &FIXT_ALGO_STATIC_KEY)
+#endif
@@ -0,0 +1,387 @@
+/*
+ * File: fixt_analysis.c
+ * Description: Offline schedulability analysis of task sets
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "fixt_task.h"
+#include "fixt_set.h"
+#include "fixt_analysis.h"
+
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/*
+ * All time arithmetic is done in quanta, wide enough for long hyperperiods.
+ */
+typedef long long quanta_t;
+
+/*
+ * Slack allowed when comparing a floating point utilization against 1.
+ */
+#define UTIL_EPSILON 1e-9
+
+static quanta_t ceil_div(quanta_t a, quanta_t b)
+{
+	return (a + b - 1) / b;
+}
+
+/*
+ * The parameters of n tasks, column by column, in the order analysed.
+ */
+struct analysis_cols
+{
+	int *c, *p, *d;
+	int n;
+};
+
+/*
+ * Allocate columns for n tasks.
+ */
+static void analysis_cols_new(struct analysis_cols* cols, int n)
+{
+	int* block = malloc(MAX(3 * n, 1) * sizeof(int));
+	cols->c = block;
+	cols->p = block + n;
+	cols->d = block + 2 * n;
+	cols->n = n;
+}
+
+static void analysis_cols_del(struct analysis_cols* cols)
+{
+	free(cols->c);
+}
+
+/*
+ * Gather the parameters of an array of tasks, in array order.
+ */
+static void analysis_cols_gather(struct analysis_cols* cols,
+		struct fixt_task** tasks, int n)
+{
+	analysis_cols_new(cols, n);
+	int i;
+	for (i = 0; i < n; i++) {
+		cols->c[i] = tasks[i]->tk_c;
+		cols->p[i] = tasks[i]->tk_p;
+		cols->d[i] = tasks[i]->tk_d;
+	}
+}
+
+/*
+ * Gather the parameters of a set's tasks, in table order.
+ */
+static void analysis_cols_of_set(struct analysis_cols* cols,
+		struct fixt_set* set)
+{
+	analysis_cols_new(cols, set->ts_count);
+	int i;
+	for (i = 0; i < set->ts_count; i++) {
+		cols->c[i] = set->ts_tasks[i].tk_c;
+		cols->p[i] = set->ts_tasks[i].tk_p;
+		cols->d[i] = set->ts_tasks[i].tk_d;
+	}
+}
+
+/*
+ * Orders tasks by rate monotonic priority, matching the RMA ready queue.
+ */
+static int rm_comparator(const void* l, const void* r)
+{
+	const struct fixt_task* task_l = *(struct fixt_task* const*) l;
+	const struct fixt_task* task_r = *(struct fixt_task* const*) r;
+	if (task_l->tk_p != task_r->tk_p) {
+		return task_l->tk_p - task_r->tk_p;
+	}
+	return task_l->tk_id - task_r->tk_id;
+}
+
+const char* fixt_verdict_str(enum fixt_verdict verdict)
+{
+	switch (verdict) {
+	case FIXT_VERDICT_FAIL:
+		return "FAIL";
+	case FIXT_VERDICT_PASS:
+		return "PASS";
+	default:
+		return "UNKNOWN";
+	}
+}
+
+double fixt_analysis_utilization(struct fixt_set* set)
+{
+	double u = 0;
+	int i;
+	for (i = 0; i < set->ts_count; i++) {
+		struct fixt_task* task = &set->ts_tasks[i];
+		u += task->tk_c / (double) task->tk_p;
+	}
+	return u;
+}
+
+enum fixt_verdict fixt_analysis_ll_bound(struct fixt_set* set)
+{
+	int n = set->ts_count;
+	if (n == 0) return FIXT_VERDICT_PASS;
+
+	double u = fixt_analysis_utilization(set);
+	if (u > 1 + UTIL_EPSILON) return FIXT_VERDICT_FAIL;
+	if (u <= n * (pow(2.0, 1.0 / n) - 1)) return FIXT_VERDICT_PASS;
+	return FIXT_VERDICT_UNKNOWN;
+}
+
+enum fixt_verdict fixt_analysis_hyperbolic(struct fixt_set* set)
+{
+	double product = 1;
+	int i;
+	for (i = 0; i < set->ts_count; i++) {
+		struct fixt_task* task = &set->ts_tasks[i];
+		product *= task->tk_c / (double) task->tk_p + 1;
+	}
+
+	if (fixt_analysis_utilization(set) > 1 + UTIL_EPSILON) {
+		return FIXT_VERDICT_FAIL;
+	}
+	if (product <= 2) return FIXT_VERDICT_PASS;
+	return FIXT_VERDICT_UNKNOWN;
+}
+
+/*
+ * Worst-case response time of the task at index i when it preempts and is
+ * preempted freely: R = c_i + sum over hp(i) of ceil(R / p_j) * c_j.
+ * Returns a value past the deadline as soon as the recurrence crosses it.
+ */
+static quanta_t rta_preemptive(const int* c, const int* p, const int* d,
+		int i)
+{
+	quanta_t r = c[i], next;
+	while (true) {
+		next = c[i];
+		int j;
+		for (j = 0; j < i; j++) {
+			next += ceil_div(r, p[j]) * c[j];
+		}
+		if (next == r || next > d[i]) return next;
+		r = next;
+	}
+}
+
+/*
+ * Worst-case response time of the task at index i when jobs run to
+ * completion once started (Davis et al., revised non-preemptive RTA).
+ * Decisions are only taken on quantum boundaries, so a lower-priority job
+ * that started one quantum before the critical instant blocks for at most
+ * c_j - 1 quanta, and a higher-priority job released exactly when task i
+ * would start still goes first. Every job of i in the level-i busy period
+ * is checked, since a job may be pushed back by its own predecessor.
+ *
+ * This is exact for sporadic releases. The fixture always releases every
+ * task at quantum 0, so a set can survive a run and still fail here when
+ * its worst case needs a lower-priority job to start just before a release.
+ */
+static quanta_t rta_non_preemptive(const int* c, const int* p,
+		const int* d, int n, int i)
+{
+	int j;
+
+	quanta_t blocking = 0;
+	double u = 0;
+	for (j = 0; j < n; j++) {
+		if (j > i) blocking = MAX(blocking, c[j] - 1);
+		if (j <= i) u += c[j] / (double) p[j];
+	}
+
+	/*
+	 * The level-i busy period never ends if higher-or-equal priority work
+	 * alone fills the processor. Call that a miss rather than loop forever.
+	 */
+	if (u > 1 + UTIL_EPSILON || (u > 1 - UTIL_EPSILON && blocking > 0)) {
+		return (quanta_t) d[i] + 1;
+	}
+
+	/* Length of the level-i busy period */
+	quanta_t busy = blocking + c[i], next;
+	while (true) {
+		next = blocking;
+		for (j = 0; j <= i; j++) {
+			next += ceil_div(busy, p[j]) * c[j];
+		}
+		if (next == busy) break;
+		busy = next;
+	}
+
+	quanta_t worst = 0;
+	quanta_t jobs = ceil_div(busy, p[i]);
+	quanta_t q;
+	for (q = 0; q < jobs; q++) {
+		/* Start time of job q, counting hp releases up to and including w */
+		quanta_t w = blocking + q * c[i], r;
+		while (true) {
+			next = blocking + q * c[i];
+			for (j = 0; j < i; j++) {
+				next += (w / p[j] + 1) * c[j];
+			}
+			r = next + c[i] - q * p[i];
+			if (next == w || r > d[i]) break;
+			w = next;
+		}
+		worst = MAX(worst, r);
+		if (worst > d[i]) break;
+	}
+	return worst;
+}
+
+/*
+ * Response-time analysis proper, over columns in priority order.
+ */
+static enum fixt_verdict rta(struct analysis_cols* cols, bool preemptive)
+{
+	const int *c = cols->c, *p = cols->p, *d = cols->d;
+	int n = cols->n;
+
+	int i;
+	for (i = 0; i < n; i++) {
+		/* A single job per busy window only holds for d <= p */
+		if (d[i] > p[i]) return FIXT_VERDICT_UNKNOWN;
+	}
+
+	for (i = 0; i < n; i++) {
+		quanta_t r;
+		if (preemptive) {
+			r = rta_preemptive(c, p, d, i);
+		} else {
+			r = rta_non_preemptive(c, p, d, n, i);
+		}
+		if (r > d[i]) return FIXT_VERDICT_FAIL;
+	}
+	return FIXT_VERDICT_PASS;
+}
+
+enum fixt_verdict fixt_analysis_rta(struct fixt_task** tasks, int n,
+		bool preemptive)
+{
+	struct analysis_cols cols;
+	analysis_cols_gather(&cols, tasks, n);
+
+	enum fixt_verdict verdict = rta(&cols, preemptive);
+
+	analysis_cols_del(&cols);
+	return verdict;
+}
+
+enum fixt_verdict fixt_analysis_rm(struct fixt_set* set, bool preemptive)
+{
+	int n = set->ts_count, i;
+	struct fixt_task** tasks = malloc(MAX(n, 1) * sizeof(*tasks));
+	for (i = 0; i < n; i++) {
+		tasks[i] = &set->ts_tasks[i];
+	}
+	qsort(tasks, n, sizeof(*tasks), &rm_comparator);
+
+	enum fixt_verdict verdict = fixt_analysis_rta(tasks, n, preemptive);
+
+	free(tasks);
+	return verdict;
+}
+
+/*
+ * Processor demand h(t): execution of every job with its release and
+ * deadline both inside [0, t].
+ */
+static quanta_t qpa_demand(const int* c, const int* p, const int* d, int n,
+		quanta_t t)
+{
+	quanta_t h = 0;
+	int i;
+	for (i = 0; i < n; i++) {
+		if (t >= d[i]) {
+			h += ((t - d[i]) / p[i] + 1) * c[i];
+		}
+	}
+	return h;
+}
+
+/*
+ * The largest absolute deadline strictly before t, or -1 if there is none.
+ */
+static quanta_t qpa_deadline_before(const int* p, const int* d, int n,
+		quanta_t t)
+{
+	quanta_t best = -1;
+	int i;
+	for (i = 0; i < n; i++) {
+		if (t > d[i]) {
+			quanta_t k = (t - 1 - d[i]) / p[i];
+			best = MAX(best, k * p[i] + d[i]);
+		}
+	}
+	return best;
+}
+
+/*
+ * QPA proper, over the columns of n tasks.
+ */
+static enum fixt_verdict qpa(const int* c, const int* p, const int* d, int n)
+{
+	int i;
+	double u = 0;
+	quanta_t sum_c = 0, d_min = 0, d_max = 0;
+	for (i = 0; i < n; i++) {
+		u += c[i] / (double) p[i];
+		sum_c += c[i];
+		d_min = (i == 0) ? d[i] : MIN(d_min, d[i]);
+		d_max = MAX(d_max, d[i]);
+	}
+	if (n == 0) return FIXT_VERDICT_PASS;
+	if (u > 1 + UTIL_EPSILON) return FIXT_VERDICT_FAIL;
+
+	/* Synchronous busy period: always a valid bound on the interval */
+	quanta_t l = sum_c, next;
+	while (true) {
+		next = 0;
+		for (i = 0; i < n; i++) {
+			next += ceil_div(l, p[i]) * c[i];
+		}
+		if (next == l) break;
+		l = next;
+	}
+
+	/* When U < 1, the bound of Zhang & Burns may be tighter */
+	if (u < 1 - UTIL_EPSILON) {
+		double la = 0;
+		for (i = 0; i < n; i++) {
+			la += (p[i] - d[i])
+					* (c[i] / (double) p[i]);
+		}
+		la = MAX((double) d_max, la / (1 - u));
+		l = MIN(l, (quanta_t) ceil(la));
+	}
+
+	/* Start from the last deadline in [0, L] and walk backwards */
+	quanta_t t = qpa_deadline_before(p, d, n, l + 1);
+	if (t < 0) return FIXT_VERDICT_PASS; /* No deadline in the interval */
+
+	quanta_t h = qpa_demand(c, p, d, n, t);
+	while (h <= t && h > d_min) {
+		if (h < t) {
+			t = h;
+		} else {
+			t = qpa_deadline_before(p, d, n, t);
+		}
+		h = qpa_demand(c, p, d, n, t);
+	}
+	return (h <= d_min) ? FIXT_VERDICT_PASS : FIXT_VERDICT_FAIL;
+}
+
+enum fixt_verdict fixt_analysis_qpa(struct fixt_set* set)
+{
+	/* Deadlines are checked in no particular order, so use the set's own */
+	struct analysis_cols cols;
+	analysis_cols_of_set(&cols, set);
+
+	enum fixt_verdict verdict = qpa(cols.c, cols.p, cols.d, cols.n);
+
+	analysis_cols_del(&cols);
+	return verdict;
+}
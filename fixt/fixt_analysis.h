@@ -0,0 +1,69 @@
+/*
+ * File: fixt_analysis.h
+ * Description: Offline schedulability analysis of task sets
+ */
+
+#ifndef FIXT_ANALYSIS_H_
+#define FIXT_ANALYSIS_H_
+
+#include <stdbool.h>
+
+struct fixt_set;
+struct fixt_task;
+
+/*
+ * Outcome of a schedulability test. Sufficient-only tests answer PASS or
+ * UNKNOWN; exact tests answer PASS or FAIL.
+ */
+enum fixt_verdict
+{
+	FIXT_VERDICT_FAIL,
+	FIXT_VERDICT_PASS,
+	FIXT_VERDICT_UNKNOWN
+};
+
+/*
+ * Printable name of a verdict.
+ */
+const char* fixt_verdict_str(enum fixt_verdict);
+
+/*
+ * Total utilization: the sum of c / p over the set.
+ */
+double fixt_analysis_utilization(struct fixt_set*);
+
+/*
+ * Liu & Layland bound for rate monotonic scheduling with implicit deadlines:
+ * PASS if U <= n(2^(1/n) - 1), FAIL if U > 1, UNKNOWN otherwise.
+ */
+enum fixt_verdict fixt_analysis_ll_bound(struct fixt_set*);
+
+/*
+ * Hyperbolic bound (Bini & Buttazzo) for rate monotonic scheduling with
+ * implicit deadlines: PASS if the product of (U_i + 1) is at most 2.
+ */
+enum fixt_verdict fixt_analysis_hyperbolic(struct fixt_set*);
+
+/*
+ * Exact response-time analysis for any fixed-priority order given as an
+ * array of n tasks, highest priority first. Deadlines must not exceed
+ * periods. When preemptive is false, jobs run to completion once started
+ * and each task may be blocked by one lower-priority job, as in the RMA
+ * fixture, whose decisions fall on quantum boundaries.
+ */
+enum fixt_verdict fixt_analysis_rta(struct fixt_task**, int n,
+		bool preemptive);
+
+/*
+ * Response-time analysis under rate monotonic priorities (shortest period
+ * first, ties broken by task id like the RMA ready queue).
+ */
+enum fixt_verdict fixt_analysis_rm(struct fixt_set*, bool preemptive);
+
+/*
+ * Exact processor-demand test for preemptive EDF with deadlines no larger
+ * than periods, using Quick Processor-demand Analysis (Zhang & Burns).
+ */
+enum fixt_verdict fixt_analysis_qpa(struct fixt_set*);
+
+#endif
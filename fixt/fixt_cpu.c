@@ -0,0 +1,34 @@
+/*
+ * File: fixt_cpu.c
+ * Description: Processor topology and thread placement
+ */
+
+#include "plat/plat.h"
+#include "fixt_cpu.h"
+
+int fixt_cpu_count()
+{
+	int n = plat_cpu_count();
+	return n < FIXT_CPU_MAX ? n : FIXT_CPU_MAX;
+}
+
+void fixt_cpu_pin(int cpu)
+{
+	if (cpu == FIXT_CPU_ANY) return;
+
+	/* The mask only applies to the calling thread, not its children */
+	plat_cpu_mask(pthread_self(), 1u << cpu);
+}
+
+void fixt_cpu_unpin()
+{
+	int n = fixt_cpu_count();
+	unsigned mask = n < FIXT_CPU_MAX ? (1u << n) - 1 : ~0u;
+	plat_cpu_mask(pthread_self(), mask);
+}
+
+void fixt_cpu_pin_thread(pthread_t thread, int cpu)
+{
+	if (cpu == FIXT_CPU_ANY) return;
+	plat_cpu_mask(thread, 1u << cpu);
+}
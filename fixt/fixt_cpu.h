@@ -0,0 +1,36 @@
+/*
+ * File: fixt_cpu.h
+ * Description: Processor topology and thread placement
+ */
+
+#ifndef FIXT_CPU_H_
+#define FIXT_CPU_H_
+
+#include <pthread.h>
+
+#define FIXT_CPU_ANY -1 /* Thread may run on any processor */
+#define FIXT_CPU_MAX 32 /* Width of a plat_cpu_mask() */
+
+/*
+ * Return the number of processors on the host (at most FIXT_CPU_MAX)
+ */
+int fixt_cpu_count();
+
+/*
+ * Restrict the calling thread to a single processor. Passing FIXT_CPU_ANY
+ * leaves the thread where it is.
+ */
+void fixt_cpu_pin(int cpu);
+
+/*
+ * Let the calling thread run on any processor again.
+ */
+void fixt_cpu_unpin();
+
+/*
+ * Restrict another thread of this process to a single processor, moving it
+ * there if it is running elsewhere. Passing FIXT_CPU_ANY does nothing.
+ */
+void fixt_cpu_pin_thread(pthread_t, int cpu);
+
+#endif
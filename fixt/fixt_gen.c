@@ -0,0 +1,90 @@
+/*
+ * File: fixt_gen.c
+ * Description: Random task set generation
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "fixt_set.h"
+#include "fixt_gen.h"
+
+#define GEN_DISCARD_TRIES 1000 /* Draws before UUniFast-Discard gives up */
+
+void fixt_gen_seed(struct fixt_gen* gen, uint64_t seed)
+{
+	gen->gn_state = seed;
+}
+
+/*
+ * SplitMix64 (Steele, Lea & Flood): tiny, and good enough for drawing task
+ * parameters. Any seed, 0 included, gives a full-period stream.
+ */
+static uint64_t fixt_gen_next(struct fixt_gen* gen)
+{
+	uint64_t z = (gen->gn_state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+double fixt_gen_uniform(struct fixt_gen* gen)
+{
+	/* The top 53 bits, as many as a double holds */
+	return (fixt_gen_next(gen) >> 11) * (1.0 / (1ULL << 53));
+}
+
+bool fixt_gen_uunifast(struct fixt_gen* gen, int n, double u, double* out)
+{
+	int tries;
+	for (tries = 0; tries < GEN_DISCARD_TRIES; tries++) {
+		double sum = u;
+		bool fits = true;
+		int i;
+		for (i = 0; i < n - 1; i++) {
+			double next = sum * pow(fixt_gen_uniform(gen), 1.0 / (n - 1 - i));
+			out[i] = sum - next;
+			sum = next;
+			if (out[i] > 1) fits = false;
+		}
+		out[n - 1] = sum;
+		if (sum > 1) fits = false;
+
+		if (fits) return true;
+	}
+	return false;
+}
+
+struct fixt_set* fixt_gen_set(struct fixt_gen* gen, int id,
+		struct fixt_gen_params* params)
+{
+	int n = params->gp_n;
+	double* util = malloc(n * sizeof(*util));
+	if (!fixt_gen_uunifast(gen, n, params->gp_u, util)) {
+		free(util);
+		return NULL;
+	}
+
+	struct fixt_set* set = fixt_set_alloc(id, n);
+	double span = log((double) params->gp_pmax / params->gp_pmin);
+	int i;
+	for (i = 0; i < n; i++) {
+		/* Log-uniform: every decade of periods is as likely as the next */
+		int p = (int) floor(params->gp_pmin
+				* exp(fixt_gen_uniform(gen) * span) + 0.5);
+		if (p > params->gp_pmax) p = params->gp_pmax;
+
+		int c = (int) floor(util[i] * p + 0.5);
+		if (c < 1) c = 1;
+		if (c > p) c = p;
+
+		double x = params->gp_dmin
+				+ fixt_gen_uniform(gen) * (1 - params->gp_dmin);
+		int d = c + (int) floor(x * (p - c) + 0.5);
+		if (d > p) d = p;
+
+		fixt_set_add(set, i, c, p, d);
+	}
+
+	free(util);
+	return set;
+}
@@ -0,0 +1,62 @@
+/*
+ * File: fixt_gen.h
+ * Description: Random task set generation
+ */
+
+#ifndef FIXT_GEN_H_
+#define FIXT_GEN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct fixt_set;
+
+/*
+ * What a generated set looks like. Utilizations are drawn with
+ * UUniFast-Discard (Bini & Buttazzo; Davis & Burns), uniformly over all
+ * ways of splitting gp_u among gp_n tasks of at most 1 each. Periods are
+ * drawn log-uniform from [gp_pmin, gp_pmax] quanta, and c is the task's
+ * share of its period, rounded, and at least 1, so the set's utilization
+ * lands near gp_u rather than on it. Deadlines are drawn uniform from
+ * [c + gp_dmin (p - c), p]: gp_dmin of 1 gives implicit deadlines,
+ * anything less constrained ones.
+ */
+struct fixt_gen_params
+{
+	int gp_n; /* Tasks per set */
+	double gp_u; /* Total utilization to aim for */
+	int gp_pmin, gp_pmax; /* Period range, in quanta */
+	double gp_dmin; /* Least deadline, as a fraction of p - c past c */
+};
+
+/*
+ * A seeded source of task sets: the same seed gives the same sets, on any
+ * host.
+ */
+struct fixt_gen
+{
+	uint64_t gn_state;
+};
+
+void fixt_gen_seed(struct fixt_gen*, uint64_t seed);
+
+/*
+ * Return a number drawn uniform from [0, 1).
+ */
+double fixt_gen_uniform(struct fixt_gen*);
+
+/*
+ * Split u into n utilizations, none above 1, with UUniFast-Discard. Returns
+ * false if every try within a bound had a task above 1, as happens with u
+ * close to n.
+ */
+bool fixt_gen_uunifast(struct fixt_gen*, int n, double u, double* out);
+
+/*
+ * Generate a task set to the given parameters, with tasks numbered from 0.
+ * Returns NULL if no utilizations could be drawn.
+ */
+struct fixt_set* fixt_gen_set(struct fixt_gen*, int id,
+		struct fixt_gen_params*);
+
+#endif
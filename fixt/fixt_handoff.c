@@ -0,0 +1,89 @@
+/*
+ * File: fixt_handoff.c
+ * Description: Lightweight semaphore for scheduler/task handoffs
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include "fixt_handoff.h"
+
+void fixt_handoff_init(struct fixt_handoff* hf, int spin)
+{
+	hf->hf_count = 0;
+	hf->hf_spin = spin;
+	sem_init(&hf->hf_park, 0, 0); /* Parking always blocks at first */
+}
+
+void fixt_handoff_destroy(struct fixt_handoff* hf)
+{
+	sem_destroy(&hf->hf_park);
+}
+
+bool fixt_handoff_trywait(struct fixt_handoff* hf)
+{
+	int count = __atomic_load_n(&hf->hf_count, __ATOMIC_RELAXED);
+	while (count > 0) {
+		/* A failed exchange reloads count, so just try again */
+		if (__atomic_compare_exchange_n(&hf->hf_count, &count, count - 1,
+				true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Spin for a post, then register as a waiter. Returns true if a post was
+ * taken, or false if the caller now has to park.
+ */
+static bool fixt_handoff_enter(struct fixt_handoff* hf)
+{
+	int i;
+	for (i = 0; i < hf->hf_spin; i++) {
+		if (fixt_handoff_trywait(hf)) return true;
+	}
+	return __atomic_fetch_sub(&hf->hf_count, 1, __ATOMIC_ACQUIRE) > 0;
+}
+
+void fixt_handoff_post(struct fixt_handoff* hf)
+{
+	/* A negative count means somebody is parked and owed a wakeup */
+	if (__atomic_fetch_add(&hf->hf_count, 1, __ATOMIC_RELEASE) < 0) {
+		sem_post(&hf->hf_park);
+	}
+}
+
+void fixt_handoff_wait(struct fixt_handoff* hf)
+{
+	if (fixt_handoff_enter(hf)) return;
+	while (sem_wait(&hf->hf_park) == -1 && errno == EINTR)
+		;
+}
+
+bool fixt_handoff_timedwait(struct fixt_handoff* hf,
+		const struct timespec* abstime)
+{
+	if (fixt_handoff_enter(hf)) return true;
+
+	int rc;
+	while ((rc = sem_timedwait(&hf->hf_park, abstime)) == -1
+			&& errno == EINTR)
+		;
+	if (rc == 0) return true;
+
+	/*
+	 * Timed out, but a post may have counted on us in the meantime. Either
+	 * withdraw as a waiter, or take the wakeup that post is sending.
+	 */
+	int count = __atomic_load_n(&hf->hf_count, __ATOMIC_RELAXED);
+	while (count < 0) {
+		if (__atomic_compare_exchange_n(&hf->hf_count, &count, count + 1,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			return false;
+		}
+	}
+	while (sem_wait(&hf->hf_park) == -1 && errno == EINTR)
+		;
+	return true;
+}
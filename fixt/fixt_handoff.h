@@ -0,0 +1,63 @@
+/*
+ * File: fixt_handoff.h
+ * Description: Lightweight semaphore for scheduler/task handoffs
+ */
+
+#ifndef FIXT_HANDOFF_H_
+#define FIXT_HANDOFF_H_
+
+#include <time.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+/*
+ * Iterations a waiter spins on the count before parking, when spinning is
+ * asked for. Around a few microseconds on the target hardware.
+ */
+#define FIXT_HANDOFF_SPIN 4000
+
+/*
+ * A counting semaphore which only enters the kernel when a thread really has
+ * to sleep or be woken. The count lives in a word updated with atomics: a
+ * post into a handoff nobody is parked on is a single atomic add, and a wait
+ * which finds a post is a single compare-and-swap. Waiters may spin on the
+ * word for a while before parking on the backing semaphore, which pays off
+ * when the poster runs on another processor. Meant to be embedded by value.
+ */
+struct fixt_handoff
+{
+	int hf_count; /* Posts not yet taken, or minus the number of parked */
+	int hf_spin; /* Iterations to spin before parking (0: park at once) */
+	sem_t hf_park; /* Waiters sleep here once they are done spinning */
+};
+
+/*
+ * Start the handoff with no posts. Waiters spin for the given number of
+ * iterations before parking. Don't spin when the poster can only run on the
+ * waiter's own processor at a lower priority: it would be starved.
+ */
+void fixt_handoff_init(struct fixt_handoff*, int spin);
+void fixt_handoff_destroy(struct fixt_handoff*);
+
+/*
+ * Add a post, waking one parked waiter if there is one.
+ */
+void fixt_handoff_post(struct fixt_handoff*);
+
+/*
+ * Take a post, blocking until there is one.
+ */
+void fixt_handoff_wait(struct fixt_handoff*);
+
+/*
+ * Take a post, blocking no later than the absolute CLOCK_REALTIME time.
+ * Returns true if a post was taken.
+ */
+bool fixt_handoff_timedwait(struct fixt_handoff*, const struct timespec*);
+
+/*
+ * Take a post if there is one. Never blocks.
+ */
+bool fixt_handoff_trywait(struct fixt_handoff*);
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * File: fixt_heap.c
+ * Description: Indexed binary min-heap of tasks used as the ready queue
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "fixt_task.h"
+#include "fixt_heap.h"
+
+#define HEAP_PARENT(i) (((i) - 1) / 2)
+#define HEAP_LEFT(i) (2 * (i) + 1)
+
+/*
+ * Locate the node this heap uses inside a task.
+ */
+static struct fixt_heap_node* heap_node(struct fixt_heap* heap,
+		struct fixt_task* task)
+{
+	return (struct fixt_heap_node*) ((char*) task + heap->hp_node);
+}
+
+/*
+ * Return true if task l belongs above task r in the heap.
+ */
+static bool heap_before(struct fixt_heap* heap, struct fixt_task* l,
+		struct fixt_task* r)
+{
+	int key_l = heap_node(heap, l)->hn_key;
+	int key_r = heap_node(heap, r)->hn_key;
+	if (key_l != key_r) {
+		return key_l < key_r;
+	}
+	return l->tk_id < r->tk_id;
+}
+
+/*
+ * Place a task at slot i and keep its back-reference in sync.
+ */
+static void heap_place(struct fixt_heap* heap, int i, struct fixt_task* task)
+{
+	heap->hp_tasks[i] = task;
+	heap_node(heap, task)->hn_idx = i;
+}
+
+static void heap_sift_up(struct fixt_heap* heap, int i)
+{
+	struct fixt_task* task = heap->hp_tasks[i];
+	while (i > 0) {
+		struct fixt_task* parent = heap->hp_tasks[HEAP_PARENT(i)];
+		if (!heap_before(heap, task, parent)) break;
+		heap_place(heap, i, parent);
+		i = HEAP_PARENT(i);
+	}
+	heap_place(heap, i, task);
+}
+
+static void heap_sift_down(struct fixt_heap* heap, int i)
+{
+	struct fixt_task* task = heap->hp_tasks[i];
+	int child;
+	while ((child = HEAP_LEFT(i)) < heap->hp_size) {
+		/* Pick the smaller of the two children */
+		if (child + 1 < heap->hp_size
+				&& heap_before(heap, heap->hp_tasks[child + 1],
+						heap->hp_tasks[child])) {
+			child++;
+		}
+		if (!heap_before(heap, heap->hp_tasks[child], task)) break;
+		heap_place(heap, i, heap->hp_tasks[child]);
+		i = child;
+	}
+	heap_place(heap, i, task);
+}
+
+void fixt_heap_init_at(struct fixt_heap* heap, int cap, size_t node)
+{
+	if (cap < 1) cap = 1;
+	heap->hp_tasks = malloc(cap * sizeof(*heap->hp_tasks));
+	heap->hp_size = 0;
+	heap->hp_cap = cap;
+	heap->hp_node = node;
+}
+
+void fixt_heap_free(struct fixt_heap* heap)
+{
+	fixt_heap_clear(heap);
+	free(heap->hp_tasks);
+	heap->hp_tasks = NULL;
+	heap->hp_cap = 0;
+}
+
+void fixt_heap_clear(struct fixt_heap* heap)
+{
+	int i;
+	for (i = 0; i < heap->hp_size; i++) {
+		heap_node(heap, heap->hp_tasks[i])->hn_idx = -1;
+	}
+	heap->hp_size = 0;
+}
+
+void fixt_heap_push(struct fixt_heap* heap, struct fixt_task* task, int key)
+{
+	if (heap->hp_size == heap->hp_cap) {
+		heap->hp_cap *= 2;
+		heap->hp_tasks = realloc(heap->hp_tasks,
+				heap->hp_cap * sizeof(*heap->hp_tasks));
+	}
+	heap_node(heap, task)->hn_key = key;
+	heap_place(heap, heap->hp_size, task);
+	heap->hp_size++;
+	heap_sift_up(heap, heap->hp_size - 1);
+}
+
+void fixt_heap_remove(struct fixt_heap* heap, struct fixt_task* task)
+{
+	struct fixt_heap_node* node = heap_node(heap, task);
+	int i = node->hn_idx;
+	node->hn_idx = -1;
+
+	heap->hp_size--;
+	if (i == heap->hp_size) return; /* Removed the last slot, nothing moves */
+
+	/* Fill the hole with the last task and let it settle either way */
+	struct fixt_task* last = heap->hp_tasks[heap->hp_size];
+	heap_place(heap, i, last);
+	heap_sift_up(heap, i);
+	if (heap_node(heap, last)->hn_idx == i) {
+		heap_sift_down(heap, i);
+	}
+}
+
+void fixt_heap_rekey(struct fixt_heap* heap, struct fixt_task* task, int key)
+{
+	struct fixt_heap_node* node = heap_node(heap, task);
+	node->hn_key = key;
+	heap_sift_up(heap, node->hn_idx);
+	heap_sift_down(heap, node->hn_idx);
+}
+
+struct fixt_task* fixt_heap_peek(struct fixt_heap* heap)
+{
+	return heap->hp_size > 0 ? heap->hp_tasks[0] : NULL;
+}
+
+struct fixt_task* fixt_heap_peek_except(struct fixt_heap* heap,
+		struct fixt_task* skip)
+{
+	if (heap->hp_size == 0) return NULL;
+	if (heap->hp_tasks[0] != skip) return heap->hp_tasks[0];
+
+	/* The runner-up is always one of the root's children */
+	if (heap->hp_size == 1) return NULL;
+	if (heap->hp_size == 2) return heap->hp_tasks[1];
+	if (heap_before(heap, heap->hp_tasks[2], heap->hp_tasks[1])) {
+		return heap->hp_tasks[2];
+	}
+	return heap->hp_tasks[1];
+}
+
+int fixt_heap_key(struct fixt_heap* heap, struct fixt_task* task)
+{
+	return heap_node(heap, task)->hn_key;
+}
+
+bool fixt_heap_contains(struct fixt_heap* heap, struct fixt_task* task)
+{
+	return heap_node(heap, task)->hn_idx >= 0;
+}
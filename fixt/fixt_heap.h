@@ -0,0 +1,89 @@
+/*
+ * File: fixt_heap.h
+ * Description: Indexed binary min-heap of tasks used as the ready queue
+ */
+
+#ifndef FIXT_HEAP_H_
+#define FIXT_HEAP_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+struct fixt_task;
+
+/*
+ * Per-heap bookkeeping embedded in struct fixt_task. A task carries one node
+ * for each heap it can belong to, so it may sit in several heaps at once.
+ */
+struct fixt_heap_node
+{
+	int hn_key; /* Cached key the task is ordered by */
+	int hn_idx; /* Slot in the heap array, or -1 if not in the heap */
+};
+
+/*
+ * Tasks are ordered by the key in their node, ties broken by tk_id so that
+ * the ordering matches the stable sort the queue used to be built with. Each
+ * node remembers its own slot, which makes removal and re-keying O(log n)
+ * without searching the heap.
+ */
+struct fixt_heap
+{
+	struct fixt_task** hp_tasks; /* Heap array, minimum at index 0 */
+	int hp_size; /* Number of tasks currently in the heap */
+	int hp_cap; /* Allocated length of hp_tasks */
+	size_t hp_node; /* Offset of this heap's node within struct fixt_task */
+};
+
+/*
+ * Initialize an empty heap with room for cap tasks. The heap grows as needed.
+ * The node argument names the struct fixt_heap_node member of struct
+ * fixt_task this heap uses, e.g. fixt_heap_init(&h, n, tk_ready).
+ */
+#define fixt_heap_init(heap, cap, node) \
+	fixt_heap_init_at(heap, cap, offsetof(struct fixt_task, node))
+void fixt_heap_init_at(struct fixt_heap*, int cap, size_t node);
+void fixt_heap_free(struct fixt_heap*);
+
+/*
+ * Remove every task from the heap without releasing its storage.
+ */
+void fixt_heap_clear(struct fixt_heap*);
+
+/*
+ * Insert a task which is not yet in the heap under the given key.
+ */
+void fixt_heap_push(struct fixt_heap*, struct fixt_task*, int key);
+
+/*
+ * Remove a task which is currently in the heap.
+ */
+void fixt_heap_remove(struct fixt_heap*, struct fixt_task*);
+
+/*
+ * Change the key of a task in the heap and restore the heap order in place.
+ */
+void fixt_heap_rekey(struct fixt_heap*, struct fixt_task*, int key);
+
+/*
+ * Return the task with the smallest key, or NULL if the heap is empty.
+ */
+struct fixt_task* fixt_heap_peek(struct fixt_heap*);
+
+/*
+ * Return the task with the smallest key other than skip, or NULL if there
+ * is none. Runs in constant time.
+ */
+struct fixt_task* fixt_heap_peek_except(struct fixt_heap*, struct fixt_task*);
+
+/*
+ * Return the key a task is stored under in this heap.
+ */
+int fixt_heap_key(struct fixt_heap*, struct fixt_task*);
+
+/*
+ * Return true if the task currently sits in this heap.
+ */
+bool fixt_heap_contains(struct fixt_heap*, struct fixt_task*);
+
+#endif
@@ -8,8 +8,22 @@
 #ifndef FIXT_HOOK_
 #define FIXT_HOOK_
 
+#include "fixt_analysis.h"
+
 struct fixt_algo;
+struct fixt_task;
+struct fixt_set;
 
 typedef void (*AlgoHook)(struct fixt_algo*);
 
+/*
+ * Computes the ready queue key of a task. Smaller keys run first.
+ */
+typedef int (*AlgoKey)(struct fixt_algo*, struct fixt_task*);
+
+/*
+ * Analytically decides whether a task set is schedulable by an algorithm.
+ */
+typedef enum fixt_verdict (*AlgoVerdict)(struct fixt_set*);
+
 #endif
@@ -0,0 +1,124 @@
+/*
+ * File: fixt_partition.c
+ * Description: Bin-packing of task sets onto multiple processors
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "fixt_task.h"
+#include "fixt_set.h"
+#include "fixt_analysis.h"
+#include "fixt_partition.h"
+
+/*
+ * Slack allowed when comparing a floating point utilization against 1.
+ */
+#define UTIL_EPSILON 1e-9
+
+/*
+ * Orders tasks by decreasing utilization, ties broken by task id.
+ */
+static int decreasing_comparator(const void* l, const void* r)
+{
+	struct fixt_task* task_l = *(struct fixt_task**) l;
+	struct fixt_task* task_r = *(struct fixt_task**) r;
+	long long u_l = (long long) task_l->tk_c * task_r->tk_p;
+	long long u_r = (long long) task_r->tk_c * task_l->tk_p;
+	if (u_l != u_r) {
+		return u_l > u_r ? -1 : 1;
+	}
+	return task_l->tk_id - task_r->tk_id;
+}
+
+/*
+ * Decide whether a core's set (with the candidate already appended) passes.
+ */
+static bool admits(struct fixt_set* core, AlgoVerdict admit)
+{
+	if (!admit) {
+		return fixt_analysis_utilization(core) <= 1 + UTIL_EPSILON;
+	}
+	return admit(core) == FIXT_VERDICT_PASS;
+}
+
+const char* fixt_partition_fit_str(enum fixt_partition_fit fit)
+{
+	switch (fit) {
+	case FIXT_PARTITION_FIRST_FIT:
+		return "FFD";
+	case FIXT_PARTITION_BEST_FIT:
+		return "BFD";
+	default:
+		return "WFD";
+	}
+}
+
+struct fixt_set** fixt_partition(struct fixt_set* set, int cores,
+		enum fixt_partition_fit fit, AlgoVerdict admit)
+{
+	int n = set->ts_count, i;
+
+	struct fixt_task** order = malloc((n ? n : 1) * sizeof(*order));
+	for (i = 0; i < n; i++) {
+		order[i] = &set->ts_tasks[i];
+	}
+	qsort(order, n, sizeof(*order), &decreasing_comparator);
+
+	/* Any core may end up with every task, so each gets room for them all */
+	struct fixt_set** part = malloc(cores * sizeof(*part));
+	double* util = malloc(cores * sizeof(*util));
+	int k;
+	for (k = 0; k < cores; k++) {
+		part[k] = fixt_set_alloc(set->ts_id, n);
+		util[k] = 0;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct fixt_task* task = order[i];
+		double u = task->tk_c / (double) task->tk_p;
+
+		/* Offer a copy of the task to every core, keeping the fittest */
+		int chosen = -1;
+		for (k = 0; k < cores; k++) {
+			fixt_set_add(part[k], task->tk_id, task->tk_c, task->tk_p,
+					task->tk_d);
+			bool ok = admits(part[k], admit);
+			fixt_set_pop(part[k]);
+			if (!ok) continue;
+
+			if (chosen == -1
+					|| (fit == FIXT_PARTITION_BEST_FIT
+							&& util[k] > util[chosen])
+					|| (fit == FIXT_PARTITION_WORST_FIT
+							&& util[k] < util[chosen])) {
+				chosen = k;
+			}
+			if (fit == FIXT_PARTITION_FIRST_FIT) break;
+		}
+
+		if (chosen == -1) {
+			fixt_partition_del(part, cores);
+			part = NULL;
+			break;
+		}
+
+		struct fixt_task* placed = fixt_set_add(part[chosen], task->tk_id,
+				task->tk_c, task->tk_p, task->tk_d);
+		fixt_task_set_work(placed, task->tk_work.sw_kind,
+				task->tk_work.sw_bytes);
+		util[chosen] += u;
+	}
+
+	free(util);
+	free(order);
+	return part;
+}
+
+void fixt_partition_del(struct fixt_set** part, int cores)
+{
+	int k;
+	for (k = 0; k < cores; k++) {
+		fixt_set_del(part[k]);
+	}
+	free(part);
+}
@@ -0,0 +1,41 @@
+/*
+ * File: fixt_partition.h
+ * Description: Bin-packing of task sets onto multiple processors
+ */
+
+#ifndef FIXT_PARTITION_H_
+#define FIXT_PARTITION_H_
+
+#include "fixt_hook.h"
+
+struct fixt_set;
+
+/*
+ * Which admitting core a task is placed on. Tasks are always offered in
+ * order of decreasing utilization (FFD, BFD and WFD).
+ */
+enum fixt_partition_fit
+{
+	FIXT_PARTITION_FIRST_FIT, /* Lowest numbered core */
+	FIXT_PARTITION_BEST_FIT, /* Core left with the least spare utilization */
+	FIXT_PARTITION_WORST_FIT /* Core left with the most spare utilization */
+};
+
+/*
+ * Printable name of a heuristic.
+ */
+const char* fixt_partition_fit_str(enum fixt_partition_fit);
+
+/*
+ * Split a task set across cores. A core admits a task only if its tasks plus
+ * the new one still PASS the admission test, typically the algorithm's
+ * al_analyze. Without a test, a core admits while its utilization stays at
+ * or below 1. Returns an array of cores new sets, some possibly empty, which
+ * hold copies of the tasks (with their original ids) and share the id of
+ * the original set. Returns NULL if some task fits on no core.
+ */
+struct fixt_set** fixt_partition(struct fixt_set*, int cores,
+		enum fixt_partition_fit, AlgoVerdict admit);
+void fixt_partition_del(struct fixt_set**, int cores);
+
+#endif
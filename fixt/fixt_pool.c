@@ -0,0 +1,179 @@
+/*
+ * File: fixt_pool.c
+ * Description: Persistent pool of threads which run task routines
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "fixt_task.h"
+#include "fixt_cpu.h"
+#include "fixt_handoff.h"
+#include "fixt_pool.h"
+
+#include "log/log.h"
+#include "log/kernel_trace.h"
+
+static struct fixt_pool_thread* pool_idle = NULL;
+static struct fixt_pool_thread* pool_all = NULL;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Touch the top of the stack so that a task's first job doesn't take the
+ * page faults.
+ */
+static void fixt_pool_prefault()
+{
+	/* Called through a volatile pointer, the memset can't be elided */
+	void* (*volatile touch)(void*, int, size_t) = &memset;
+	char stack[FIXT_POOL_PREFAULT];
+	touch(stack, 0, sizeof(stack));
+}
+
+/*
+ * Park a thread between tasks under the default policy, so that it keeps
+ * nothing of the real-time policy and priority its last task ran with.
+ */
+static void fixt_pool_park(pthread_t thread)
+{
+	struct sched_param sched;
+	sched.sched_priority = sched_get_priority_min(SCHED_OTHER);
+	pthread_setschedparam(thread, SCHED_OTHER, &sched);
+}
+
+static void* fixt_pool_main(void* arg)
+{
+	struct fixt_pool_thread* pt = (struct fixt_pool_thread*) arg;
+
+	fixt_pool_prefault();
+
+	while (true) {
+		fixt_handoff_wait(&pt->pt_bind);
+		struct fixt_task* task = pt->pt_task;
+		if (!task) break; /* The pool is closing */
+
+		task->tk_routine(task);
+
+		/* Leave nothing of the task behind for the next one */
+		fixt_cpu_unpin();
+		k_log_csv_bind(NULL);
+		fixt_handoff_post(&pt->pt_unbind);
+	}
+
+	return NULL;
+}
+
+/*
+ * Create a thread and add it to the pool. Call with pool_lock held.
+ * Returns NULL, having reported why, if no thread could be created.
+ */
+static struct fixt_pool_thread* fixt_pool_spawn()
+{
+	struct fixt_pool_thread* pt = malloc(sizeof(*pt));
+	pt->pt_task = NULL;
+	fixt_handoff_init(&pt->pt_bind, 0);
+	fixt_handoff_init(&pt->pt_unbind, 0);
+
+	/* Parked from the start, whatever the creating scheduler runs under */
+	struct sched_param sched;
+	sched.sched_priority = sched_get_priority_min(SCHED_OTHER);
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, FIXT_POOL_STACK);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+	pthread_attr_setschedparam(&attr, &sched);
+	int err = pthread_create(&pt->pt_thread, &attr, &fixt_pool_main, pt);
+	pthread_attr_destroy(&attr);
+
+	if (err) {
+		fprintf(stderr, " [ fixt_pool ] pthread_create: %s\n", strerror(err));
+		fixt_handoff_destroy(&pt->pt_bind);
+		fixt_handoff_destroy(&pt->pt_unbind);
+		free(pt);
+		return NULL;
+	}
+
+	pt->pt_all_next = pool_all;
+	pool_all = pt;
+	return pt;
+}
+
+void fixt_pool_init(int threads)
+{
+	log_func(1, "fixt_pool_init");
+
+	pthread_mutex_lock(&pool_lock);
+	int i;
+	for (i = 0; i < threads; i++) {
+		/* Short of threads, the pool grows on demand in fixt_pool_bind() */
+		struct fixt_pool_thread* pt = fixt_pool_spawn();
+		if (!pt) break;
+		pt->pt_idle_next = pool_idle;
+		pool_idle = pt;
+	}
+	pthread_mutex_unlock(&pool_lock);
+
+	log_fend(1, "fixt_pool_init");
+}
+
+void fixt_pool_term()
+{
+	log_func(1, "fixt_pool_term");
+
+	pthread_mutex_lock(&pool_lock);
+	struct fixt_pool_thread *pt, *next;
+	for (pt = pool_all; pt; pt = next) {
+		next = pt->pt_all_next;
+		pt->pt_task = NULL;
+		fixt_handoff_post(&pt->pt_bind);
+		pthread_join(pt->pt_thread, NULL);
+		fixt_handoff_destroy(&pt->pt_bind);
+		fixt_handoff_destroy(&pt->pt_unbind);
+		free(pt);
+	}
+	pool_all = NULL;
+	pool_idle = NULL;
+	pthread_mutex_unlock(&pool_lock);
+
+	log_fend(1, "fixt_pool_term");
+}
+
+struct fixt_pool_thread* fixt_pool_bind(struct fixt_task* task, int policy,
+		int prio)
+{
+	pthread_mutex_lock(&pool_lock);
+	struct fixt_pool_thread* pt = pool_idle;
+	if (pt) {
+		pool_idle = pt->pt_idle_next;
+	} else {
+		pt = fixt_pool_spawn();
+	}
+	pthread_mutex_unlock(&pool_lock);
+
+	/* A task with no thread to run it would hang its scheduler for good */
+	if (!pt) exit(EXIT_FAILURE);
+
+	/* The thread takes on the policy it would have been created with */
+	struct sched_param sched;
+	sched.sched_priority = prio;
+	pthread_setschedparam(pt->pt_thread, policy, &sched);
+
+	pt->pt_task = task;
+	fixt_handoff_post(&pt->pt_bind);
+	return pt;
+}
+
+void fixt_pool_unbind(struct fixt_pool_thread* pt)
+{
+	fixt_handoff_wait(&pt->pt_unbind);
+	pt->pt_task = NULL;
+	fixt_pool_park(pt->pt_thread);
+
+	pthread_mutex_lock(&pool_lock);
+	pt->pt_idle_next = pool_idle;
+	pool_idle = pt;
+	pthread_mutex_unlock(&pool_lock);
+}
@@ -0,0 +1,60 @@
+/*
+ * File: fixt_pool.h
+ * Description: Persistent pool of threads which run task routines
+ */
+
+#ifndef FIXT_POOL_H_
+#define FIXT_POOL_H_
+
+#include <pthread.h>
+#include "fixt_handoff.h"
+
+#define FIXT_POOL_STACK (128 * 1024) /* Stack size of a pooled thread */
+#define FIXT_POOL_PREFAULT (64 * 1024) /* Stack touched up front */
+
+struct fixt_task;
+
+/*
+ * A thread which outlives the tasks it runs. Binding a task hands the
+ * thread the task's routine; the thread returns to the pool once the
+ * routine does.
+ */
+struct fixt_pool_thread
+{
+	pthread_t pt_thread;
+	struct fixt_task* pt_task; /* Task bound to the thread (NULL: closing) */
+	struct fixt_handoff pt_bind; /* Posted to hand the thread its task */
+	struct fixt_handoff pt_unbind; /* Posted once the task's routine returns */
+
+	struct fixt_pool_thread* pt_idle_next; /* Idle list of the pool */
+	struct fixt_pool_thread* pt_all_next; /* Every thread of the pool */
+};
+
+/*
+ * Start the given number of threads up front, each with its stack already
+ * faulted in, so that binding tasks needs no thread creation. The pool
+ * grows past this if more tasks are bound at once.
+ */
+void fixt_pool_init(int threads);
+
+/*
+ * Stop and join every pooled thread. No task may be bound.
+ */
+void fixt_pool_term();
+
+/*
+ * Run task->tk_routine on an idle pooled thread with the given scheduling
+ * policy and priority. Safe to call from several schedulers at once. Exits
+ * the process if the pool has to grow and no thread can be created.
+ */
+struct fixt_pool_thread* fixt_pool_bind(struct fixt_task*, int policy,
+		int prio);
+
+/*
+ * Wait for the bound task's routine to return, then put its thread back in
+ * the pool, unpinned, under the default policy and logging to the global
+ * trace.
+ */
+void fixt_pool_unbind(struct fixt_pool_thread*);
+
+#endif
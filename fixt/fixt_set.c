@@ -11,6 +11,18 @@
 #include "fixt_task.h"
 #include "fixt_set.h"
 
+struct fixt_set* fixt_set_alloc(int id, int cap)
+{
+	struct fixt_set* set = malloc(sizeof(*set));
+	set->ts_id = id;
+	set->ts_count = 0;
+	set->ts_cap = cap;
+
+	set->ts_tasks = malloc(cap * sizeof(struct fixt_task));
+
+	return set;
+}
+
 /*
  * Create a new task set comprised of multiple tasks. The first parameter is
  * the task set id. The second parameter is the number of following params.
@@ -21,13 +33,10 @@ struct fixt_set* fixt_set_new(int id, int size, ...)
 {
 	assert(size % 3 == 0); /* We need groups of three to create tasks */
 
-	struct fixt_set* set = malloc(sizeof(*set));
-	set->ts_id = id;
-	set->ts_set_head = NULL;
+	struct fixt_set* set = fixt_set_alloc(id, size / 3);
 
 	va_list tuples;
 	int tuple;
-	struct fixt_task* task;
 
 	va_start(tuples, size);
 	for (tuple = 0; tuple < size; tuple += 3) /* Advance index by 3 */
@@ -36,8 +45,7 @@ struct fixt_set* fixt_set_new(int id, int size, ...)
 		int p = va_arg(tuples, int);
 		int d = va_arg(tuples, int);
 
-		task = fixt_task_new(tuple / 3, c, p, d);
-		DL_APPEND2(set->ts_set_head, task, _ts_prev, _ts_next);
+		fixt_set_add(set, tuple / 3, c, p, d);
 	}
 	va_end(tuples);
 
@@ -46,11 +54,40 @@ struct fixt_set* fixt_set_new(int id, int size, ...)
 
 void fixt_set_del(struct fixt_set* set)
 {
-	struct fixt_task *elt, *tmp;
-	DL_FOREACH_SAFE2(set->ts_set_head, elt, tmp, _ts_next)
+	free(set->ts_tasks);
+	free(set);
+}
+
+struct fixt_task* fixt_set_add(struct fixt_set* set, int id, int c, int p,
+		int d)
+{
+	assert(set->ts_count < set->ts_cap); /* Tasks must never move */
+
+	int i = set->ts_count++;
+	struct fixt_task* task = &set->ts_tasks[i];
+	fixt_task_init(task, id, c, p, d);
+
+	return task;
+}
+
+void fixt_set_pop(struct fixt_set* set)
+{
+	assert(set->ts_count > 0);
+	set->ts_count--;
+}
+
+struct fixt_set* fixt_set_clone(struct fixt_set* set)
+{
+	struct fixt_set* copy = fixt_set_alloc(set->ts_id, set->ts_count);
+
+	int i;
+	for (i = 0; i < set->ts_count; i++)
 	{
-		DL_DELETE2(set->ts_set_head, elt, _ts_prev, _ts_next);
-		fixt_task_del(elt);
+		struct fixt_task* elt = &set->ts_tasks[i];
+		struct fixt_task* task = fixt_set_add(copy, elt->tk_id, elt->tk_c,
+				elt->tk_p, elt->tk_d);
+		fixt_task_set_work(task, elt->tk_work.sw_kind, elt->tk_work.sw_bytes);
 	}
-	free(set);
+
+	return copy;
 }
@@ -12,10 +12,23 @@
 #include "utlist.h"
 #include "fixt_task.h"
 
+/*
+ * A set keeps its tasks in a table: one contiguous array of tasks, indexed
+ * 0 to ts_count - 1, so that walking the set never chases pointers. The
+ * table is sized when the set is created, so a task never moves while the
+ * set lives.
+ *
+ * c, p and d live in the tasks, not in columns of their own: a decision
+ * only visits the O(log n) tasks its ready heap and release wheel reach,
+ * reading each whole, and no pass walks a parameter over every task. A
+ * column would cost each of those visits a second cache line.
+ */
 struct fixt_set
 {
 	int ts_id; /* Id number of the set for logging purposes */
-	struct fixt_task* ts_set_head; /* The head of the doubly linked list */
+	int ts_count; /* Number of tasks in the table */
+	int ts_cap; /* Number of tasks the table has room for */
+	struct fixt_task* ts_tasks; /* The task table */
 
 	/* Used privately by utlist */
 	struct fixt_set* prev;
@@ -31,4 +44,26 @@ struct fixt_set
 struct fixt_set* fixt_set_new(int, int, ...);
 void fixt_set_del(struct fixt_set*);
 
+/*
+ * Create an empty task set with room for cap tasks.
+ */
+struct fixt_set* fixt_set_alloc(int id, int cap);
+
+/*
+ * Append a task to the table, which must have room for it. Returns the
+ * task, which belongs to the set.
+ */
+struct fixt_task* fixt_set_add(struct fixt_set*, int id, int c, int p, int d);
+
+/*
+ * Drop the task added last.
+ */
+void fixt_set_pop(struct fixt_set*);
+
+/*
+ * Create a new task set with the same id and task tuples, but tasks of its
+ * own, so that it can be run while the original is also running.
+ */
+struct fixt_set* fixt_set_clone(struct fixt_set*);
+
 #endif
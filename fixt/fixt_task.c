@@ -8,21 +8,20 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <unistd.h>
-#include <fcntl.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdbool.h>
 #include "spin/spin.h"
+#include "plat/plat.h"
+#include "fixt_cpu.h"
+#include "fixt_pool.h"
 #include "fixt_task.h"
 
 #include "log/log.h"
 #include "log/kernel_trace.h"
+#include "log/histogram.h"
 
-/*
- * Value sent over the poison pill pipe indicating a thread should end
- * as soon as possible
- */
-static const int POISON_PILL = 1;
+#define NS_PER_QUANTUM (SPIN_QUANTUM_WIDTH_MS * 1000000LL)
 
 /*
  * The routine which is run as the task in a new thread
@@ -32,56 +31,111 @@ static void* fixt_task_routine(void*);
 struct fixt_task* fixt_task_new(int id, int c, int p, int d)
 {
 	struct fixt_task* task = malloc(sizeof *task);
+	fixt_task_init(task, id, c, p, d);
+	return task;
+}
+
+void fixt_task_init(struct fixt_task* task, int id, int c, int p, int d)
+{
 	task->tk_id = id;
 
 	task->tk_a = 0; /* To start, a task has run for 0 quanta */
 	task->tk_c = c;
 	task->tk_p = p;
 	task->tk_d = d;
-	task->tk_r = 0; /* To start, all tasks are ready */
+	task->tk_release = 0; /* To start, all tasks are ready */
+	task->tk_deadline = d;
 	task->tk_routine = &fixt_task_routine;
+	spin_work_init(&task->tk_work, SPIN_WORK_SPIN, 0);
+	task->tk_worker = NULL; /* Bound to a pooled thread only while running */
+
+	task->tk_cpu = FIXT_CPU_ANY; /* Placement is up to the algo */
+	task->tk_core = -1;
+	task->tk_trace = NULL;
+
+	task->tk_release_ns = 0;
+	task->tk_deadline_ns = 0;
+	task->tk_response = NULL; /* Up to the algo which runs the task */
+	task->tk_misses = 0;
+	task->tk_tardiness_ns = 0;
+
+	task->tk_ready.hn_key = 0;
+	task->tk_ready.hn_idx = -1; /* Not in any ready queue yet */
+	task->tk_slack.hn_key = 0;
+	task->tk_slack.hn_idx = -1;
+	task->tk_wheel_slot = -1; /* Not waiting in any release calendar */
+
+	task->_tw_prev = NULL;
+	task->_tw_next = NULL;
+}
 
-	/* OOPS - we should find a better way to do lists */
-	task->_ts_prev = NULL;
-	task->_ts_next = NULL;
-	task->_at_prev = NULL;
-	task->_at_next = NULL;
-	task->_aq_prev = NULL;
-	task->_aq_next = NULL;
+void fixt_task_reset(struct fixt_task* task)
+{
+	task->tk_a = 0;
+	task->tk_release = 0;
+	task->tk_deadline = task->tk_d;
+	task->tk_core = -1;
+}
 
-	return task;
+void fixt_task_stamp(struct fixt_task* task, long long epoch_ns)
+{
+	task->tk_release_ns = epoch_ns + task->tk_release * NS_PER_QUANTUM;
+	task->tk_deadline_ns = epoch_ns + task->tk_deadline * NS_PER_QUANTUM;
+	task->tk_misses = 0;
+	task->tk_tardiness_ns = 0;
 }
 
-sem_t* fixt_task_run(struct fixt_task* task, int policy, int prio)
+void fixt_task_complete(struct fixt_task* task, long long release_ns,
+		long long deadline_ns, long long now_ns)
 {
-	/* Every time a task is run from scratch, re-init tk_a and tk_r */
-	task->tk_a = 0;
-	task->tk_r = 0;
+	if (task->tk_response) {
+		k_log_hist_add(task->tk_response, now_ns - release_ns);
+	}
+	if (now_ns > deadline_ns) {
+		task->tk_misses++;
+		task->tk_tardiness_ns += now_ns - deadline_ns;
+	}
+}
+
+void fixt_task_set_routine(struct fixt_task* task, void* (*routine)(void*))
+{
+	task->tk_routine = routine ? routine : &fixt_task_routine;
+}
+
+void fixt_task_set_work(struct fixt_task* task, enum spin_work_kind kind,
+		size_t bytes)
+{
+	spin_work_init(&task->tk_work, kind, bytes);
+}
 
-	pipe(task->tk_poison_pipe);
-	/* Set to nonblocking. A thread join is used to sync threads instead */
-	fcntl(task->tk_poison_pipe[0], F_SETFL, O_NONBLOCK);
-	fcntl(task->tk_poison_pipe[1], F_SETFL, O_NONBLOCK);
+struct fixt_handoff* fixt_task_run(struct fixt_task* task, int policy,
+		int prio)
+{
+	/* Every time a task is run from scratch, its first job starts at 0 */
+	fixt_task_reset(task);
+
+	task->tk_stop = 0; /* Written before a thread is bound to read it */
 
-	task->tk_sem_cont = malloc(sizeof(*task->tk_sem_cont));
-	sem_init(task->tk_sem_cont, 0, 0); /* First sem_wait blocks */
+	/* Fault the working set in now, rather than in the first job */
+	spin_work_alloc(&task->tk_work);
 
-	task->tk_sem_done = malloc(sizeof(*task->tk_sem_done));
-	sem_init(task->tk_sem_done, 0, 0); /* First sem_wait blocks */
+	/*
+	 * Unpinned, the scheduler and task likely sit on different processors,
+	 * so a short spin can catch the other side's post without sleeping.
+	 * Pinned together, or with only one processor to go around, a spinning
+	 * scheduler would only starve the task.
+	 */
+	bool apart = task->tk_cpu == FIXT_CPU_ANY && fixt_cpu_count() > 1;
+	int spin = apart ? FIXT_HANDOFF_SPIN : 0;
+	fixt_handoff_init(&task->tk_cont, spin); /* First wait blocks */
+	fixt_handoff_init(&task->tk_done, spin); /* First wait blocks */
 
 	/*
 	 * The thread should have the appropriate scheduling policy when it
 	 * starts. Thread priority is managed by the scheduler
 	 */
-	pthread_attr_t attr;
-	pthread_attr_init(&attr);
-	pthread_attr_setschedpolicy(&attr, policy);
-	struct sched_param sched;
-	sched.sched_priority = prio;
-	pthread_attr_setschedparam(&attr, &sched);
-
-	pthread_t t;
-	pthread_create(&t, &attr, task->tk_routine, (void*) task);
+	task->tk_worker = fixt_pool_bind(task, policy, prio);
+	pthread_t t = task->tk_worker->pt_thread;
 
 	char buf[20];
 	int tk_c = fixt_task_get_c(task);
@@ -92,13 +146,11 @@ sem_t* fixt_task_run(struct fixt_task* task, int policy, int prio)
 
 	task->tk_thread = t;
 
-	return task->tk_sem_cont;
+	return &task->tk_cont;
 }
 
 void fixt_task_del(struct fixt_task* task)
 {
-	free(task->tk_sem_cont);
-	free(task->tk_sem_done);
 	free(task);
 }
 
@@ -106,15 +158,20 @@ void fixt_task_stop(struct fixt_task* task)
 {
 	log_func(4, "fixt_task_stop");
 
-	write(task->tk_poison_pipe[1], &POISON_PILL, sizeof(POISON_PILL));
-	sem_post(task->tk_sem_cont);
+	/*
+	 * The flag is published before the post, so the thread sees it when the
+	 * post wakes it, whether it was parked waiting or only gets there after
+	 * finishing its current job.
+	 */
+	__atomic_store_n(&task->tk_stop, 1, __ATOMIC_RELEASE);
+	fixt_handoff_post(&task->tk_cont);
 
-	pthread_join(task->tk_thread, NULL);
-	close(task->tk_poison_pipe[0]);
-	close(task->tk_poison_pipe[1]);
+	fixt_pool_unbind(task->tk_worker);
+	task->tk_worker = NULL;
 
-	sem_destroy(task->tk_sem_cont);
-	sem_destroy(task->tk_sem_done);
+	fixt_handoff_destroy(&task->tk_cont);
+	fixt_handoff_destroy(&task->tk_done);
+	spin_work_free(&task->tk_work);
 
 	log_fend(4, "fixt_task_stop");
 }
@@ -123,28 +180,41 @@ static void* fixt_task_routine(void* arg)
 {
 	struct fixt_task* task = (struct fixt_task*) arg;
 
-	int pill;
+	/* Share the processor and trace of the scheduler which started us */
+	fixt_cpu_pin(task->tk_cpu);
+	k_log_csv_bind(task->tk_trace);
+
 	while (true) {
 		/* Wait for the scheduler to post */
-		sem_wait(task->tk_sem_cont);
+		fixt_handoff_wait(&task->tk_cont);
 
 		/* If the thread was told to quit while waiting, quit now! */
-		read(task->tk_poison_pipe[0], &pill, sizeof(POISON_PILL));
-		if (pill == POISON_PILL) break;
+		if (__atomic_load_n(&task->tk_stop, __ATOMIC_ACQUIRE)) break;
+
+		/*
+		 * The scheduler stamped this job before posting, and restamps the
+		 * task for the next job once it believes this one is done, which
+		 * may be before we finish. So hold on to this job's stamps.
+		 */
+		long long release_ns = task->tk_release_ns;
+		long long deadline_ns = task->tk_deadline_ns;
 
 		/* Preemption handles splitting execution across quanta! */
 		k_log_s(task->tk_id);
-		spin_for(task->tk_c);
+		spin_work_for(&task->tk_work, task->tk_c);
 		k_log_e(task->tk_id);
 
+		/* Check the job against its deadline on the clock */
+		fixt_task_complete(task, release_ns, deadline_ns, k_log_hist_now());
+
 		log_msg(5, " [ SPIN DONE ]");
 
 		/*
 		 * Notify the scheduler that this task is done executing. As soon as
 		 * this goes through, we immediately loose control. We don't get to
-		 * sem_wait above until this thread is unblocked.
+		 * wait above until this thread is unblocked.
 		 */
-		sem_post(task->tk_sem_done);
+		fixt_handoff_post(&task->tk_done);
 	}
 
 	return NULL;
@@ -157,7 +227,7 @@ void fixt_task_set_prio(struct fixt_task* task, int prio)
 
 void fixt_task_set_param(struct fixt_task* task, int param)
 {
-	pthread_setschedparam(task->tk_thread, param, NULL);
+	plat_thread_policy(task->tk_thread, param);
 }
 
 int fixt_task_get_a(struct fixt_task* task)
@@ -180,9 +250,14 @@ int fixt_task_get_d(struct fixt_task* task)
 	return task->tk_d;
 }
 
-int fixt_task_get_r(struct fixt_task* task)
+int fixt_task_get_release(struct fixt_task* task)
+{
+	return task->tk_release;
+}
+
+int fixt_task_get_deadline(struct fixt_task* task)
 {
-	return task->tk_r;
+	return task->tk_deadline;
 }
 
 bool fixt_task_already_executing(struct fixt_task* task)
@@ -195,17 +270,31 @@ int fixt_task_completion_time(struct fixt_task* task)
 	return task->tk_c - task->tk_a;
 }
 
-int fixt_task_remaining_time(struct fixt_task* task)
+int fixt_task_remaining_time(struct fixt_task* task, int now)
 {
-	return task->tk_d + task->tk_r;
+	return task->tk_deadline - now;
+}
+
+int fixt_task_latest_start(struct fixt_task* task)
+{
+	return task->tk_deadline - fixt_task_completion_time(task);
+}
+
+void fixt_task_next_job(struct fixt_task* task)
+{
+	task->tk_a = 0;
+	task->tk_release += task->tk_p;
+	task->tk_deadline = task->tk_release + task->tk_d;
+	task->tk_release_ns += task->tk_p * NS_PER_QUANTUM;
+	task->tk_deadline_ns = task->tk_release_ns + task->tk_d * NS_PER_QUANTUM;
 }
 
-sem_t* fixt_task_get_sem_cont(struct fixt_task* task)
+struct fixt_handoff* fixt_task_get_cont(struct fixt_task* task)
 {
-	return task->tk_sem_cont;
+	return &task->tk_cont;
 }
 
-sem_t* fixt_task_get_sem_done(struct fixt_task* task)
+struct fixt_handoff* fixt_task_get_done(struct fixt_task* task)
 {
-	return task->tk_sem_done;
+	return &task->tk_done;
 }
@@ -13,30 +13,61 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdbool.h>
+#include "fixt_heap.h"
+#include "fixt_handoff.h"
+#include "spin/workload.h"
+
+struct k_log_csv;
+struct k_log_hist;
+struct fixt_pool_thread;
 
 /*
  * See the architecture doc for more on this structure.
  */
 struct fixt_task
 {
+	/*
+	 * Everything the scheduler touches on each decision comes first, so that
+	 * it shares a cache line or two with its neighbours in the set's table.
+	 */
 	int tk_id; /* Task id */
 
 	int tk_a; /* Task run time accumlated in a single scheduler period */
 	int tk_c, tk_p, tk_d; /* Execution time, period, deadline */
-	int tk_r; /* Nuber of quanta until ready to execute */
-
-	void* (*tk_routine)(void*); /* The routine run in a new thread */
-
-	int tk_poison_pipe[2]; /* Pipe to inform the thread when to stop */
-	pthread_t tk_thread;
-
-	sem_t* tk_sem_cont; /* Scheduler releases task via posting this */
-	sem_t* tk_sem_done; /* Task completes execution by posting this */
-
-	/* Private use by utlist.h - OOPS our lists were clobbering each other */
-	struct fixt_task *_ts_prev, *_ts_next; /* Task set list */
-	struct fixt_task *_at_prev, *_at_next; /* Algo task list */
-	struct fixt_task *_aq_prev, *_aq_next; /* Algo queue list */
+	int tk_release; /* Absolute quantum the current job is released at */
+	int tk_deadline; /* Absolute quantum the current job is due by */
+
+	struct fixt_heap_node tk_ready; /* Node in the algo ready queue */
+	struct fixt_heap_node tk_slack; /* Node in the algo min-slack heap */
+	int tk_wheel_slot; /* Slot in the algo release calendar, or -1 */
+	int tk_core; /* Core of a global algo the task last ran on, or -1 */
+
+	/* Private use by utlist.h */
+	struct fixt_task *_tw_prev, *_tw_next; /* Algo release calendar slot */
+
+	/* Thread state, only touched when releasing or reprioritizing */
+	void* (*tk_routine)(void*); /* The routine run on a pooled thread */
+	struct spin_work tk_work; /* What each job does with its time */
+
+	int tk_stop; /* Set (atomically) to tell the thread to stop */
+	struct fixt_pool_thread* tk_worker; /* Pooled thread bound to the task */
+	pthread_t tk_thread; /* That thread's id, for reprioritizing it */
+
+	struct fixt_handoff tk_cont; /* Scheduler releases task via posting this */
+	struct fixt_handoff tk_done; /* Task completes execution by posting this */
+
+	int tk_cpu; /* Processor the thread is pinned to, or FIXT_CPU_ANY */
+	struct k_log_csv* tk_trace; /* Trace the thread logs to (NULL: global) */
+
+	/*
+	 * The current job on the clock, as set by the scheduler before the job
+	 * is released, and what the thread found when its jobs completed.
+	 */
+	long long tk_release_ns; /* Time the current job is released at */
+	long long tk_deadline_ns; /* Time the current job is due by */
+	struct k_log_hist* tk_response; /* Release to completion of every job */
+	int tk_misses; /* Jobs which completed past their deadline */
+	long long tk_tardiness_ns; /* Time those jobs ran past their deadline */
 };
 
 /*
@@ -47,13 +78,55 @@ struct fixt_task* fixt_task_new(int id, int c, int p, int d);
 void fixt_task_del(struct fixt_task*);
 
 /*
- * Start up the backing routine in a new thread and initialize semaphores
+ * Initialize a task in place, e.g. a slot of a task set's table. Such tasks
+ * belong to the table and must not be passed to fixt_task_del().
+ */
+void fixt_task_init(struct fixt_task*, int id, int c, int p, int d);
+
+/*
+ * Rewind the task's bookkeeping so that its first job is released at 0
  */
-sem_t* fixt_task_run(struct fixt_task*, int policy, int prio);
+void fixt_task_reset(struct fixt_task*);
 
 /*
- * Send a poison pill to the task, then join on that task. Also reset
- * runtime data structures for future runs.
+ * Stamp the current job with its release time and deadline on the clock,
+ * taking epoch_ns as quantum 0, and clear the task's miss counts. Jobs
+ * retired from then on are stamped a period after the last.
+ */
+void fixt_task_stamp(struct fixt_task*, long long epoch_ns);
+
+/*
+ * Account for a job, released and due at the given times, which completed
+ * at now_ns: its response time, and whether and by how much it was late.
+ * Called by the task's thread, or by whoever plays it in a simulation.
+ */
+void fixt_task_complete(struct fixt_task*, long long release_ns,
+		long long deadline_ns, long long now_ns);
+
+/*
+ * Have the task's thread run the given routine, passed the task, in place
+ * of the usual one: wait for a post on tk_cont, run a job, post tk_done.
+ * Passing NULL restores the usual routine. Must be set before
+ * fixt_task_run().
+ */
+void fixt_task_set_routine(struct fixt_task*, void* (*)(void*));
+
+/*
+ * Have each job run the given kernel over a working set of bytes (0 for
+ * the default) in place of a plain spin. The working set is allocated on
+ * fixt_task_run() and freed on fixt_task_stop().
+ */
+void fixt_task_set_work(struct fixt_task*, enum spin_work_kind,
+		size_t bytes);
+
+/*
+ * Start up the backing routine on a pooled thread and initialize handoffs
+ */
+struct fixt_handoff* fixt_task_run(struct fixt_task*, int policy, int prio);
+
+/*
+ * Tell the task to stop, wake it, then wait for its thread to go back to
+ * the pool. Also reset runtime data structures for future runs.
  */
 void fixt_task_stop(struct fixt_task*);
 
@@ -71,7 +144,8 @@ int fixt_task_get_a(struct fixt_task*);
 int fixt_task_get_c(struct fixt_task*);
 int fixt_task_get_p(struct fixt_task*);
 int fixt_task_get_d(struct fixt_task*);
-int fixt_task_get_r(struct fixt_task*);
+int fixt_task_get_release(struct fixt_task*);
+int fixt_task_get_deadline(struct fixt_task*);
 
 /*
  * Return true if the task is already partway through its' execution time
@@ -84,18 +158,31 @@ bool fixt_task_already_executing(struct fixt_task* task);
 int fixt_task_completion_time(struct fixt_task*);
 
 /*
- * Return the number of quanta remaining until this task's deadline
+ * Return the number of quanta remaining until this task's deadline, given
+ * the current absolute quantum
+ */
+int fixt_task_remaining_time(struct fixt_task* task, int now);
+
+/*
+ * Return the latest absolute quantum the current job can start its
+ * remaining execution and still finish by its deadline
+ */
+int fixt_task_latest_start(struct fixt_task*);
+
+/*
+ * Retire the current job and advance the release and deadline to the
+ * task's next period
  */
-int fixt_task_remaining_time(struct fixt_task* task);
+void fixt_task_next_job(struct fixt_task*);
 
 /*
- * Scheduler posts sem_cont to release the task for execution.
+ * Scheduler posts cont to release the task for execution.
  */
-sem_t* fixt_task_get_sem_cont(struct fixt_task*);
+struct fixt_handoff* fixt_task_get_cont(struct fixt_task*);
 
 /*
- * Task posts sem_done to unblock the scheduler
+ * Task posts done to unblock the scheduler
  */
-sem_t* fixt_task_get_sem_done(struct fixt_task*);
+struct fixt_handoff* fixt_task_get_done(struct fixt_task*);
 
 #endif
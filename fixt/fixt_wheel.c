@@ -0,0 +1,186 @@
+/*
+ * File: fixt_wheel.c
+ * Description: Hierarchical timing wheel of pending task releases
+ */
+
+#include <limits.h>
+#include <assert.h>
+#include "utlist.h"
+#include "fixt_task.h"
+#include "fixt_wheel.h"
+
+/*
+ * Slot marker for tasks kept on the overflow list.
+ */
+#define WHEEL_OVERFLOW (FIXT_WHEEL_LEVELS * FIXT_WHEEL_SLOTS)
+
+/*
+ * Number of time bits above which two times share a slot at a given level.
+ */
+#define WHEEL_SHIFT(level) (FIXT_WHEEL_BITS * (level))
+
+/*
+ * Put a task in the lowest level whose window holds both now and its
+ * release. A task at level L therefore always sits in a slot later than
+ * the one now falls in, which keeps the lowest set bit of each level the
+ * earliest slot at that level.
+ */
+static void wheel_place(struct fixt_wheel* wheel, struct fixt_task* task)
+{
+	int t = task->tk_release;
+	int level;
+	for (level = 0; level < FIXT_WHEEL_LEVELS; level++) {
+		int shift = WHEEL_SHIFT(level + 1);
+		if ((t >> shift) == (wheel->tw_now >> shift)) {
+			int idx = (t >> WHEEL_SHIFT(level)) & FIXT_WHEEL_MASK;
+			DL_APPEND2(wheel->tw_slots[level][idx], task, _tw_prev, _tw_next);
+			wheel->tw_occupied[level] |= (uint64_t) 1 << idx;
+			task->tk_wheel_slot = level * FIXT_WHEEL_SLOTS + idx;
+			return;
+		}
+	}
+	DL_APPEND2(wheel->tw_overflow, task, _tw_prev, _tw_next);
+	task->tk_wheel_slot = WHEEL_OVERFLOW;
+}
+
+/*
+ * Detach the whole list in a slot and mark the slot empty.
+ */
+static struct fixt_task* wheel_take(struct fixt_wheel* wheel, int level,
+		int idx)
+{
+	struct fixt_task* list = wheel->tw_slots[level][idx];
+	wheel->tw_slots[level][idx] = NULL;
+	wheel->tw_occupied[level] &= ~((uint64_t) 1 << idx);
+	return list;
+}
+
+/*
+ * Re-place every task of a detached list relative to the current time.
+ */
+static void wheel_cascade(struct fixt_wheel* wheel, struct fixt_task* list)
+{
+	struct fixt_task *elt, *tmp;
+	DL_FOREACH_SAFE2(list, elt, tmp, _tw_next) {
+		wheel_place(wheel, elt);
+	}
+}
+
+/*
+ * Set the clock to a later time. Nothing may be due strictly between the
+ * old and new time. Any slot that time has just entered is cascaded into
+ * the levels below it, highest level first.
+ */
+static void wheel_jump(struct fixt_wheel* wheel, int to)
+{
+	int from = wheel->tw_now;
+	wheel->tw_now = to;
+
+	if ((from >> WHEEL_SHIFT(FIXT_WHEEL_LEVELS))
+			!= (to >> WHEEL_SHIFT(FIXT_WHEEL_LEVELS))) {
+		struct fixt_task* list = wheel->tw_overflow;
+		wheel->tw_overflow = NULL;
+		wheel_cascade(wheel, list);
+	}
+
+	int level;
+	for (level = FIXT_WHEEL_LEVELS - 1; level > 0; level--) {
+		int shift = WHEEL_SHIFT(level);
+		if ((from >> shift) != (to >> shift)) {
+			int idx = (to >> shift) & FIXT_WHEEL_MASK;
+			wheel_cascade(wheel, wheel_take(wheel, level, idx));
+		}
+	}
+}
+
+void fixt_wheel_init(struct fixt_wheel* wheel, int now)
+{
+	int level, idx;
+	for (level = 0; level < FIXT_WHEEL_LEVELS; level++) {
+		wheel->tw_occupied[level] = 0;
+		for (idx = 0; idx < FIXT_WHEEL_SLOTS; idx++) {
+			wheel->tw_slots[level][idx] = NULL;
+		}
+	}
+	wheel->tw_overflow = NULL;
+	wheel->tw_size = 0;
+	wheel->tw_now = now;
+}
+
+void fixt_wheel_clear(struct fixt_wheel* wheel, int now)
+{
+	struct fixt_task *elt, *tmp;
+	int level, idx;
+	for (level = 0; level < FIXT_WHEEL_LEVELS; level++) {
+		for (idx = 0; idx < FIXT_WHEEL_SLOTS; idx++) {
+			DL_FOREACH_SAFE2(wheel->tw_slots[level][idx], elt, tmp, _tw_next) {
+				elt->tk_wheel_slot = -1;
+			}
+		}
+	}
+	DL_FOREACH_SAFE2(wheel->tw_overflow, elt, tmp, _tw_next) {
+		elt->tk_wheel_slot = -1;
+	}
+	fixt_wheel_init(wheel, now);
+}
+
+void fixt_wheel_insert(struct fixt_wheel* wheel, struct fixt_task* task)
+{
+	assert(task->tk_release > wheel->tw_now);
+	wheel_place(wheel, task);
+	wheel->tw_size++;
+}
+
+bool fixt_wheel_contains(struct fixt_task* task)
+{
+	return task->tk_wheel_slot >= 0;
+}
+
+int fixt_wheel_next(struct fixt_wheel* wheel)
+{
+	/*
+	 * Levels only ever hold later releases than the levels below them, so
+	 * the answer is in the first occupied slot of the lowest busy level.
+	 */
+	struct fixt_task* list = NULL;
+	int level;
+	for (level = 0; level < FIXT_WHEEL_LEVELS && !list; level++) {
+		if (wheel->tw_occupied[level]) {
+			int idx = __builtin_ctzll(wheel->tw_occupied[level]);
+			list = wheel->tw_slots[level][idx];
+		}
+	}
+	if (!list) list = wheel->tw_overflow;
+
+	int next = INT_MAX;
+	struct fixt_task* elt;
+	DL_FOREACH2(list, elt, _tw_next) {
+		if (elt->tk_release < next) next = elt->tk_release;
+	}
+	return next;
+}
+
+struct fixt_task* fixt_wheel_advance(struct fixt_wheel* wheel, int to)
+{
+	struct fixt_task* expired = NULL;
+	struct fixt_task *elt, *tmp;
+
+	int next;
+	while ((next = fixt_wheel_next(wheel)) <= to) {
+		wheel_jump(wheel, next);
+
+		/* Everything due now has cascaded into its level 0 slot */
+		struct fixt_task* due = wheel_take(wheel, 0, next & FIXT_WHEEL_MASK);
+		DL_FOREACH_SAFE2(due, elt, tmp, _tw_next) {
+			DL_DELETE2(due, elt, _tw_prev, _tw_next);
+			DL_APPEND2(expired, elt, _tw_prev, _tw_next);
+			elt->tk_wheel_slot = -1;
+			wheel->tw_size--;
+		}
+	}
+	if (to > wheel->tw_now) {
+		wheel_jump(wheel, to);
+	}
+
+	return expired;
+}
@@ -0,0 +1,70 @@
+/*
+ * File: fixt_wheel.h
+ * Description: Hierarchical timing wheel of pending task releases
+ */
+
+#ifndef FIXT_WHEEL_H_
+#define FIXT_WHEEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FIXT_WHEEL_BITS 6 /* log2 of the number of slots per level */
+#define FIXT_WHEEL_SLOTS (1 << FIXT_WHEEL_BITS)
+#define FIXT_WHEEL_MASK (FIXT_WHEEL_SLOTS - 1)
+#define FIXT_WHEEL_LEVELS 4 /* Covers 2^24 quanta before the overflow list */
+
+struct fixt_task;
+
+/*
+ * Tasks waiting for their next release, keyed on the absolute release
+ * quantum tk_release. Level 0 holds releases within the current 64 quanta,
+ * level 1 within the current 64^2 quanta, and so on. Tasks cascade down a
+ * level when time reaches their slot, so each task is touched a bounded
+ * number of times no matter how many quanta pass. Per-level occupancy
+ * bitmaps let time skip straight over empty slots.
+ */
+struct fixt_wheel
+{
+	int tw_now; /* Current absolute quantum */
+	int tw_size; /* Number of tasks waiting in the wheel */
+
+	uint64_t tw_occupied[FIXT_WHEEL_LEVELS]; /* Bit set per non-empty slot */
+	struct fixt_task* tw_slots[FIXT_WHEEL_LEVELS][FIXT_WHEEL_SLOTS];
+	struct fixt_task* tw_overflow; /* Releases beyond the top level */
+};
+
+/*
+ * Initialize an empty wheel whose clock reads now.
+ */
+void fixt_wheel_init(struct fixt_wheel*, int now);
+
+/*
+ * Drop every waiting task and reset the clock to now.
+ */
+void fixt_wheel_clear(struct fixt_wheel*, int now);
+
+/*
+ * Schedule a task to be released at its tk_release, which must be later
+ * than the wheel's current time.
+ */
+void fixt_wheel_insert(struct fixt_wheel*, struct fixt_task*);
+
+/*
+ * Return true if the task is currently waiting in a wheel.
+ */
+bool fixt_wheel_contains(struct fixt_task*);
+
+/*
+ * Return the earliest pending release time, or INT_MAX if nothing waits.
+ */
+int fixt_wheel_next(struct fixt_wheel*);
+
+/*
+ * Move the clock forward to the absolute quantum to. Returns a list
+ * (linked through _tw_prev/_tw_next) of every task whose release time
+ * arrived on the way. Those tasks are no longer in the wheel.
+ */
+struct fixt_task* fixt_wheel_advance(struct fixt_wheel*, int to);
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * File: fixt_algo_impl_dl.c
+ * Description: Implementation of fixt_algo for EDF left to the kernel
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include "spin/spin.h"
+#include "plat/plat.h"
+#include "fixt/fixt_hook.h"
+#include "fixt/fixt_algo.h"
+#include "fixt/fixt_task.h"
+#include "fixt/fixt_cpu.h"
+#include "fixt/fixt_handoff.h"
+#include "fixt_algo_impl_dl.h"
+
+#include "log/log.h"
+#include "log/kernel_trace.h"
+#include "log/histogram.h"
+
+#define POLICY_DL SCHED_FIFO /* Until each task thread enters the class */
+#define NS_PER_QUANTUM (SPIN_QUANTUM_WIDTH_MS * 1000000LL)
+
+/*
+ * The body of every task thread. The scheduler releases each thread once,
+ * all at the same time. From then on the thread is a periodic job of its
+ * own: the kernel picks which job runs, throttles any which overrun their
+ * budget, and wakes each thread at its next period once it yields.
+ *
+ * The stamps of the job in progress are kept up to date in the task, so
+ * the scheduler can tell a job pending past its deadline from the clock.
+ */
+static void* fixt_algo_impl_dl_routine(void* arg)
+{
+	struct fixt_task* task = (struct fixt_task*) arg;
+
+	/* The kernel only admits threads free to run on any processor */
+	fixt_cpu_unpin();
+	k_log_csv_bind(task->tk_trace);
+
+	/*
+	 * Besides its c quanta of spinning, each job logs, completes and posts
+	 * its done. Budget for that too, or the kernel throttles every job
+	 * into its next period just short of the end. The runtime may not
+	 * pass the deadline, so jobs with c = d get no headroom.
+	 */
+	long long runtime = task->tk_c * NS_PER_QUANTUM + DL_HEADROOM_NS;
+	if (runtime > task->tk_d * NS_PER_QUANTUM) {
+		runtime = task->tk_d * NS_PER_QUANTUM;
+	}
+
+	fixt_handoff_wait(&task->tk_cont);
+	bool stop = __atomic_load_n(&task->tk_stop, __ATOMIC_ACQUIRE);
+	bool admitted = false;
+	if (!stop) {
+		admitted = plat_thread_deadline(runtime, task->tk_d * NS_PER_QUANTUM,
+				task->tk_p * NS_PER_QUANTUM) == 0;
+		if (!admitted) {
+			printf(" [ DL TASK %d NOT ADMITTED: %s ]\n", task->tk_id,
+					strerror(errno));
+		}
+	}
+
+	/* The first period starts as the thread enters the class */
+	long long release = k_log_hist_now();
+	while (admitted && !stop) {
+		long long deadline = release + task->tk_d * NS_PER_QUANTUM;
+		__atomic_store_n(&task->tk_release_ns, release, __ATOMIC_RELAXED);
+		__atomic_store_n(&task->tk_deadline_ns, deadline, __ATOMIC_RELEASE);
+
+		/* The kernel released the job as it woke the thread */
+		k_log_s(LOG_K_ARRIVAL + task->tk_id);
+		k_log_s(task->tk_id);
+		spin_work_for(&task->tk_work, task->tk_c);
+		k_log_e(task->tk_id);
+
+		fixt_task_complete(task, release, deadline, k_log_hist_now());
+		release += task->tk_p * NS_PER_QUANTUM;
+		__atomic_store_n(&task->tk_deadline_ns,
+				release + task->tk_d * NS_PER_QUANTUM, __ATOMIC_RELEASE);
+		fixt_handoff_post(&task->tk_done);
+
+		/* Sleep out the rest of the period */
+		sched_yield();
+		stop = __atomic_load_n(&task->tk_stop, __ATOMIC_ACQUIRE);
+	}
+
+	/* Pooled threads go back as ordinary real-time threads */
+	if (admitted) plat_thread_policy(pthread_self(), POLICY_DL);
+
+	/* Stay bound until told to stop, as a task which never ran */
+	while (!stop) {
+		fixt_handoff_wait(&task->tk_cont);
+		stop = __atomic_load_n(&task->tk_stop, __ATOMIC_ACQUIRE);
+	}
+
+	return NULL;
+}
+
+/*
+ * Task threads switch classes themselves, so the scheduler thread only
+ * needs the FIFO policy. It sits below every deadline thread regardless.
+ */
+void fixt_algo_impl_dl_init(struct fixt_algo* algo)
+{
+	pthread_t self = pthread_self();
+	plat_thread_policy(self, POLICY_DL);
+}
+
+/*
+ * There is no job to pick; the kernel does that. What is left is to check
+ * that no job is pending past its deadline, which stands in for the slack
+ * check of the other algos.
+ */
+void fixt_algo_impl_dl_schedule(struct fixt_algo* algo)
+{
+	log_func(3, "dl_schedule");
+
+	algo->al_queue_head = NULL;
+
+	long long now = k_log_hist_now();
+	int i;
+	for (i = 0; i < algo->al_ntasks; i++) {
+		struct fixt_task* task = &algo->al_tasks[i];
+		if (__atomic_load_n(&task->tk_deadline_ns, __ATOMIC_ACQUIRE) < now) {
+			algo->al_schedulable = false;
+		}
+	}
+
+	log_fend(3, "dl_schedule");
+}
+
+/*
+ * The scheduler never preempts anything, so it only wakes every DL_WATCH
+ * quanta to check on the jobs and to see if the test is over.
+ */
+void fixt_algo_impl_dl_block(struct fixt_algo* algo)
+{
+	log_func(3, "dl_block");
+
+	fixt_algo_wait_all(algo, DL_WATCH, 0);
+
+	log_fend(3, "dl_block");
+}
+
+/*
+ * Count the jobs completed while blocked, from the posts on each done.
+ */
+void fixt_algo_impl_dl_recalc(struct fixt_algo* algo)
+{
+	log_func(3, "dl_recalc");
+
+	int i;
+	for (i = 0; i < algo->al_ntasks; i++) {
+		while (fixt_handoff_trywait(&algo->al_tasks[i].tk_done)) {
+			algo->al_jobs++;
+		}
+	}
+	algo->al_now += DL_WATCH;
+
+	log_fend(3, "dl_recalc");
+}
+
+/*
+ * One step: check the jobs, release every thread the first time around,
+ * then sleep. Only the scheduler phases are timed; nothing is reprioritized.
+ */
+static void fixt_algo_impl_dl_step(struct fixt_algo* algo)
+{
+	k_log_s(LOG_K_ALGO);
+	long long begin = k_log_hist_now();
+	fixt_algo_impl_dl_schedule(algo);
+	k_log_hist_add(&algo->al_phase[FIXT_PHASE_SCHEDULE],
+			k_log_hist_now() - begin);
+	k_log_e(LOG_K_ALGO);
+	if (!algo->al_schedulable && !algo->al_soft) return;
+
+	if (algo->al_now == 0) {
+		int i;
+		k_log_s(LOG_K_RELEASE);
+		for (i = 0; i < algo->al_ntasks; i++) {
+			fixt_handoff_post(fixt_task_get_cont(&algo->al_tasks[i]));
+		}
+		k_log_e(LOG_K_RELEASE);
+	}
+	fixt_algo_impl_dl_block(algo);
+
+	k_log_s(LOG_K_RECALC);
+	begin = k_log_hist_now();
+	fixt_algo_impl_dl_recalc(algo);
+	k_log_hist_add(&algo->al_phase[FIXT_PHASE_RECALC],
+			k_log_hist_now() - begin);
+	k_log_e(LOG_K_RECALC);
+}
+
+struct fixt_algo* fixt_algo_impl_dl_new()
+{
+	AlgoHook al_init = &fixt_algo_impl_dl_init;
+	AlgoHook al_schedule = &fixt_algo_impl_dl_schedule;
+	AlgoHook al_block = &fixt_algo_impl_dl_block;
+	AlgoHook al_recalc = &fixt_algo_impl_dl_recalc;
+	AlgoKey al_key = &fixt_algo_impl_dl_key;
+
+	struct fixt_algo* algo = fixt_algo_new(al_init, al_schedule, al_block,
+			al_recalc, al_key, POLICY_DL);
+	algo->al_name = "DL";
+	/* No al_analyze: DL is judged on the clock, next to EDF's own run */
+
+	/* Always its own step: the hooks alone would reprioritize threads */
+	algo->al_step = &fixt_algo_impl_dl_step;
+	algo->al_routine = &fixt_algo_impl_dl_routine;
+
+	return algo;
+}
+
+/*
+ * The ready queue goes unused, but is ordered as under EDF all the same.
+ */
+int fixt_algo_impl_dl_key(struct fixt_algo* algo, struct fixt_task* task)
+{
+	return fixt_task_get_deadline(task);
+}
@@ -0,0 +1,29 @@
+/*
+ * File: fixt_algo_impl_dl.h
+ * Description: Implementation of fixt_algo for EDF left to the kernel
+ */
+
+#ifndef FIXT_ALGO_IMPL_DL_H_
+#define FIXT_ALGO_IMPL_DL_H_
+
+#include "fixt/fixt_algo.h"
+#include "fixt/fixt_hook.h"
+
+#define DL_WATCH 10 /* Quanta the scheduler sleeps between checks on jobs */
+#define DL_HEADROOM_NS 200000 /* Budget past c for a job's own bookkeeping */
+
+void fixt_algo_impl_dl_init(struct fixt_algo*);
+void fixt_algo_impl_dl_schedule(struct fixt_algo*);
+void fixt_algo_impl_dl_block(struct fixt_algo*);
+void fixt_algo_impl_dl_recalc(struct fixt_algo*);
+int fixt_algo_impl_dl_key(struct fixt_algo*, struct fixt_task*);
+
+/*
+ * Create an Earliest Deadline First scheduling algorithm which hands every
+ * task to the kernel's deadline scheduling class (see plat_thread_deadline)
+ * rather than preempting them from the scheduler thread. Runs can't be
+ * simulated, and the host has to support such a class.
+ */
+struct fixt_algo* fixt_algo_impl_dl_new();
+
+#endif
@@ -8,24 +8,23 @@
 #include <time.h>
 #include <pthread.h>
 #include <semaphore.h>
-#include <errno.h>
 #include "utlist.h"
 #include "spin/spin.h"
+#include "plat/plat.h"
 #include "fixt/fixt_hook.h"
 #include "fixt/fixt_algo.h"
 #include "fixt/fixt_task.h"
+#include "fixt/fixt_analysis.h"
 #include "fixt_algo_impl_edf.h"
 
+/* Bind the key into requeues at compile time (see fixt_algo_static.h) */
+#define FIXT_ALGO_STATIC_KEY fixt_algo_impl_edf_key
+#include "fixt/fixt_algo_static.h"
+
 #include "log/log.h"
 
 #define POLICY_EDF SCHED_FIFO /* No preemption under EDF */
 
-/*
- * This comparator compares two tasks under EDF and generates an ordering
- * such that tasks with early deadlines have high priority.
- */
-static int edf_comparator(void*, void*);
-
 /*
  * EDF requires the fixture thread (self) and all child task threads to use a
  * FIFO policy. Since the scheduler manipulates thread priorities to align with
@@ -39,27 +38,18 @@ static int edf_comparator(void*, void*);
 void fixt_algo_impl_edf_init(struct fixt_algo* algo)
 {
 	pthread_t self = pthread_self();
-	pthread_setschedparam(self, POLICY_EDF, NULL);
+	plat_thread_policy(self, POLICY_EDF);
 }
 
 void fixt_algo_impl_edf_schedule(struct fixt_algo* algo)
 {
 	log_func(3, "edf_schedule");
 
-	/* Reset the queue so we can reschedule the tasks */
-	algo->al_queue_head = NULL;
-
-	/* Only consider tasks that are ready (r <= 0) */
-	struct fixt_task *elt;
-	DL_FOREACH2 (algo->al_tasks_head, elt, _at_next) {
-		if (fixt_task_get_r(elt) <= 0) {
-			log_rchk(4, elt);
-			DL_APPEND2(algo->al_queue_head, elt, _aq_prev, _aq_next);
-		}
-	}
-
-	/* Pull the task with the earliest deadline to the head of the queue */
-	DL_SORT2(algo->al_queue_head, (&edf_comparator), _aq_prev, _aq_next);
+	/*
+	 * Released tasks are kept in the ready queue by recalc, so the
+	 * task with the earliest deadline is already at the top of the heap.
+	 */
+	algo->al_queue_head = fixt_heap_peek(&algo->al_ready);
 
 	log_fend(3, "edf_schedule");
 }
@@ -77,13 +67,9 @@ void fixt_algo_impl_edf_block(struct fixt_algo* algo)
 {
 	log_func(3, "edf_block");
 
-	sem_t* sem_done = fixt_task_get_sem_done(algo->al_queue_head);
-	struct timespec abs_next;
-	abs_next = spin_abstime_in_quanta(EDF_PERIOD, EDF_JITTER);
-
-	if(sem_timedwait(sem_done, &abs_next) == 0) {
+	if(fixt_algo_wait(algo, EDF_PERIOD, EDF_JITTER)) {
 		log_msg(4, "[ Scheduler Resume b/c Task Completed ]");
-	} else if(errno == ETIMEDOUT) {
+	} else {
 		log_msg(4, "[ Scheduler Preemption ]");
 	}
 
@@ -91,15 +77,15 @@ void fixt_algo_impl_edf_block(struct fixt_algo* algo)
 }
 
 /*
- * Recalculate the r parameter across all tasks.
+ * Advance the release calendar past the last run.
  *
  * If a task actually ran this iteration, then the head of the queue will
- * be that task. If the queue head has completed its execution, then calculate
- * time until ready for next period. Otherwise, all tasks were ready
- * EDF_PERIOD quanta ago.
+ * be that task. If the queue head has completed its execution, then its
+ * next job is released one period after the current one. Otherwise, it
+ * stays ready. Either way, time moved forward by EDF_PERIOD quanta.
  *
- * If no task ran, then all tasks must have their r parameter normalized to
- * zero based upon the smallest r parameter in the current task pool.
+ * If no task ran, then the scheduler idled until the earliest pending
+ * release. Only tasks released along the way are touched.
  */
 void fixt_algo_impl_edf_recalc(struct fixt_algo* algo)
 {
@@ -114,53 +100,54 @@ void fixt_algo_impl_edf_recalc(struct fixt_algo* algo)
 		delta = EDF_PERIOD;
 		head->tk_a += delta; /* Add one to the task's accumlated time */
 
-		if(fixt_task_completion_time(head) > 0) {
-			/* Still execution time left: task is still ready */
-			head->tk_r = head->tk_r - delta;
-		} else {
-			/* No execution time left: calculate time til next period */
-			head->tk_r = head->tk_p - delta + head->tk_r;
-			head->tk_a = 0; /* Reset accumulated time */
+		if(fixt_task_completion_time(head) <= 0) {
+			/* No execution time left: wait for the next period */
+			fixt_algo_retire(algo, head, algo->al_now + delta);
 		}
+		fixt_algo_requeue(algo, head);
 
 		log_haft(4, head);
 	} else {
-		/* Normalize all r parameters: Δ = min(ri) */
+		/* Skip ahead to the next release: Δ = min(ri) */
 		delta = fixt_algo_min_r(algo);
 	}
 
-	/* Tasks chosen to idle: r' = r - Δ */
-	struct fixt_task* elt;
-	DL_FOREACH2(algo->al_tasks_head, elt, _at_next) {
-		/* Don't do this calculation on the queue head! */
-		if (elt != head) {
-			log_ibef(4, elt);
-
-			elt->tk_r = elt->tk_r - delta;
+	/* Tasks released during Δ join the ready queue */
+	fixt_algo_advance(algo, delta);
 
-			log_iaft(4, elt);
-		}
-	}
 	log_fend(3, "edf_recalc");
 }
 
+#if FIXT_ALGO_STATIC_DISPATCH
+FIXT_ALGO_STATIC_STEP(fixt_algo_impl_edf)
+#endif
+
 struct fixt_algo* fixt_algo_impl_edf_new()
 {
 	AlgoHook al_init = &fixt_algo_impl_edf_init;
 	AlgoHook al_schedule = &fixt_algo_impl_edf_schedule;
 	AlgoHook al_block = &fixt_algo_impl_edf_block;
 	AlgoHook al_recalc = &fixt_algo_impl_edf_recalc;
+	AlgoKey al_key = &fixt_algo_impl_edf_key;
+
+	struct fixt_algo* algo = fixt_algo_new(al_init, al_schedule, al_block,
+			al_recalc, al_key, POLICY_EDF);
+	algo->al_name = "EDF";
+	algo->al_analyze = &fixt_analysis_qpa; /* Preempts on every quantum */
 
-	return fixt_algo_new(al_init, al_schedule, al_block, al_recalc, POLICY_EDF);
+#if FIXT_ALGO_STATIC_DISPATCH
+	algo->al_step = &fixt_algo_impl_edf_step;
+#endif
+
+	return algo;
 }
 
-static int edf_comparator(void* l, void* r)
+/*
+ * Under EDF, a task's key is its absolute deadline so that tasks with early
+ * deadlines have high priority. The key only changes when a new job is
+ * released.
+ */
+int fixt_algo_impl_edf_key(struct fixt_algo* algo, struct fixt_task* task)
 {
-	struct fixt_task* task_l = (struct fixt_task*) l;
-	struct fixt_task* task_r = (struct fixt_task*) r;
-	/*
-	 * If the left task has an earlier than the right task, then the
-	 * function will return a negative number, etc.
-	 */
-	return fixt_task_remaining_time(task_l) - fixt_task_remaining_time(task_r);
+	return fixt_task_get_deadline(task);
 }
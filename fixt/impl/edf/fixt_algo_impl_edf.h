@@ -17,6 +17,7 @@
 void fixt_algo_impl_edf_init(struct fixt_algo*);
 void fixt_algo_impl_edf_schedule(struct fixt_algo*);
 void fixt_algo_impl_edf_block(struct fixt_algo*);
+int fixt_algo_impl_edf_key(struct fixt_algo*, struct fixt_task*);
 
 /*
  * Create an Earliest Deadline First scheduling algorithm
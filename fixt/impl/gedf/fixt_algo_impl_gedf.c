@@ -0,0 +1,40 @@
+/*
+ * File: fixt_algo_impl_gedf.c
+ * Description: Implementation of fixt_algo for Global Earliest Deadline First
+ */
+
+#include "fixt/fixt_algo.h"
+#include "fixt/fixt_task.h"
+#include "fixt_algo_impl_gedf.h"
+
+/* For FIXT_ALGO_STATIC_GLOBAL_STEP() */
+#include "fixt/fixt_algo_static.h"
+
+#if FIXT_ALGO_STATIC_DISPATCH
+FIXT_ALGO_STATIC_GLOBAL_STEP(fixt_algo_impl_gedf)
+#endif
+
+/*
+ * Global EDF goes through the hooks shared by all global algorithms
+ * (fixt_algo_global_new()); only its key is its own.
+ */
+struct fixt_algo* fixt_algo_impl_gedf_new(int cores)
+{
+	struct fixt_algo* algo;
+	algo = fixt_algo_global_new(&fixt_algo_impl_gedf_key, cores);
+	algo->al_name = "GEDF";
+
+#if FIXT_ALGO_STATIC_DISPATCH
+	algo->al_step = &fixt_algo_impl_gedf_step;
+#endif
+
+	return algo;
+}
+
+/*
+ * Under global EDF, a task's key is its absolute deadline, as under EDF.
+ */
+int fixt_algo_impl_gedf_key(struct fixt_algo* algo, struct fixt_task* task)
+{
+	return fixt_task_get_deadline(task);
+}
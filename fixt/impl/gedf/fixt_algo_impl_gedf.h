@@ -0,0 +1,19 @@
+/*
+ * File: fixt_algo_impl_gedf.h
+ * Description: Implementation of fixt_algo for Global Earliest Deadline First
+ */
+
+#ifndef FIXT_ALGO_IMPL_GEDF_H_
+#define FIXT_ALGO_IMPL_GEDF_H_
+
+#include "fixt/fixt_algo.h"
+
+int fixt_algo_impl_gedf_key(struct fixt_algo*, struct fixt_task*);
+
+/*
+ * Create a Global Earliest Deadline First scheduling algorithm which runs
+ * the earliest deadline jobs on the given number of cores
+ */
+struct fixt_algo* fixt_algo_impl_gedf_new(int cores);
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * File: fixt_algo_impl_gfp.c
+ * Description: Implementation of fixt_algo for Global Fixed Priority
+ */
+
+#include "fixt/fixt_algo.h"
+#include "fixt/fixt_task.h"
+#include "fixt_algo_impl_gfp.h"
+
+/* For FIXT_ALGO_STATIC_GLOBAL_STEP() */
+#include "fixt/fixt_algo_static.h"
+
+#if FIXT_ALGO_STATIC_DISPATCH
+FIXT_ALGO_STATIC_GLOBAL_STEP(fixt_algo_impl_gfp)
+#endif
+
+/*
+ * Global fixed priority goes through the hooks shared by all global
+ * algorithms (fixt_algo_global_new()); only its key is its own.
+ */
+struct fixt_algo* fixt_algo_impl_gfp_new(int cores)
+{
+	struct fixt_algo* algo;
+	algo = fixt_algo_global_new(&fixt_algo_impl_gfp_key, cores);
+	algo->al_name = "GFP";
+
+#if FIXT_ALGO_STATIC_DISPATCH
+	algo->al_step = &fixt_algo_impl_gfp_step;
+#endif
+
+	return algo;
+}
+
+/*
+ * Under global fixed priority, priorities are rate monotonic: a task's key
+ * is its period, as under RMA, except that jobs are preempted here.
+ */
+int fixt_algo_impl_gfp_key(struct fixt_algo* algo, struct fixt_task* task)
+{
+	return task->tk_p;
+}
@@ -0,0 +1,19 @@
+/*
+ * File: fixt_algo_impl_gfp.h
+ * Description: Implementation of fixt_algo for Global Fixed Priority
+ */
+
+#ifndef FIXT_ALGO_IMPL_GFP_H_
+#define FIXT_ALGO_IMPL_GFP_H_
+
+#include "fixt/fixt_algo.h"
+
+int fixt_algo_impl_gfp_key(struct fixt_algo*, struct fixt_task*);
+
+/*
+ * Create a Global Fixed Priority scheduling algorithm which runs the jobs of
+ * the shortest period tasks on the given number of cores
+ */
+struct fixt_algo* fixt_algo_impl_gfp_new(int cores);
+
+#endif
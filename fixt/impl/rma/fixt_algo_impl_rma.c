@@ -10,21 +10,21 @@
 #include <semaphore.h>
 #include "utlist.h"
 #include "spin/spin.h"
+#include "plat/plat.h"
 #include "fixt/fixt_hook.h"
 #include "fixt/fixt_algo.h"
 #include "fixt/fixt_task.h"
+#include "fixt/fixt_analysis.h"
 #include "fixt_algo_impl_rma.h"
 
+/* Bind the key into requeues at compile time (see fixt_algo_static.h) */
+#define FIXT_ALGO_STATIC_KEY fixt_algo_impl_rma_key
+#include "fixt/fixt_algo_static.h"
+
 #include "log/log.h"
 
 #define POLICY_RMA SCHED_FIFO /* No preemption under RMA */
 
-/*
- * This comparator compares two tasks under RMA and generates an ordering
- * such that tasks with small periods have high priority.
- */
-static int rma_comparator(void*, void*);
-
 /*
  * RMA requires the fixture thread (self) to use a FIFO policy.
  *
@@ -35,27 +35,18 @@ static int rma_comparator(void*, void*);
 void fixt_algo_impl_rma_init(struct fixt_algo* algo)
 {
 	pthread_t self = pthread_self();
-	pthread_setschedparam(self, POLICY_RMA, NULL);
+	plat_thread_policy(self, POLICY_RMA);
 }
 
 void fixt_algo_impl_rma_schedule(struct fixt_algo* algo)
 {
 	log_func(3, "rma_schedule");
 
-	/* Reset the queue so we can reschedule the tasks */
-	algo->al_queue_head = NULL;
-
-	/* Only consider tasks that are ready (r <= 0) */
-	struct fixt_task *elt;
-	DL_FOREACH2 (algo->al_tasks_head, elt, _at_next) {
-		if (fixt_task_get_r(elt) <= 0) {
-			log_rchk(4, elt);
-			DL_APPEND2(algo->al_queue_head, elt, _aq_prev, _aq_next);
-		}
-	}
-
-	/* Pull the task with the shortest period to the head of the queue */
-	DL_SORT2(algo->al_queue_head, (&rma_comparator), _aq_prev, _aq_next);
+	/*
+	 * Released tasks are kept in the ready queue by recalc, so the
+	 * task with the shortest period is already at the top of the heap.
+	 */
+	algo->al_queue_head = fixt_heap_peek(&algo->al_ready);
 
 	log_fend(3, "rma_schedule");
 }
@@ -68,21 +59,20 @@ void fixt_algo_impl_rma_block(struct fixt_algo* algo)
 {
 	log_func(3, "rma_block");
 
-	sem_t* sem_done = fixt_task_get_sem_done(algo->al_queue_head);
-	sem_wait(sem_done);
+	fixt_algo_wait(algo, FIXT_ALGO_WAIT_FOREVER, 0);
 
 	log_fend(3, "rma_block");
 }
 
 /*
- * Recalculate the r parameter across all tasks.
+ * Advance the release calendar past the last run.
  *
  * If a task actually ran this iteration, then the head of the queue will
- * be that task. Calculate time until ready for next period. All other tasks
- * idled. These tasks were ready tk_c quanta ago.
+ * be that task. It ran to completion, so its next job is released one
+ * period after the current one. Time moved forward by tk_c quanta.
  *
- * If no task ran, then all tasks must have their r parameter normalized to
- * zero based upon the smallest r parameter in the current task pool.
+ * If no task ran, then the scheduler idled until the earliest pending
+ * release. Only tasks released along the way are touched.
  */
 void fixt_algo_impl_rma_recalc(struct fixt_algo* algo)
 {
@@ -91,50 +81,63 @@ void fixt_algo_impl_rma_recalc(struct fixt_algo* algo)
 
 	int delta; /* The number of quanta elapsed since last run */
 	if (head) {
-		/* Queue head chosen to run: Δ = c,  r' = p - Δ + r */
+		/* Queue head chosen to run: Δ = c, release' = release + p */
 		log_hbef(4, head);
 
 		delta = head->tk_c;
-		head->tk_r = head->tk_p - delta + head->tk_r;
+		fixt_algo_retire(algo, head, algo->al_now + delta);
+		fixt_algo_requeue(algo, head);
 
 		log_haft(4, head);
 	} else {
-		/* Normalize all r parameters: Δ = min(ri) */
+		/* Skip ahead to the next release: Δ = min(ri) */
 		delta = fixt_algo_min_r(algo);
 	}
 
-	/* Tasks chosen to idle: r' = r - Δ */
-	struct fixt_task* elt;
-	DL_FOREACH2(algo->al_tasks_head, elt, _at_next) {
-		/* Don't do this calculation on the queue head! */
-		if (elt != head) {
-			log_ibef(4, elt);
+	/* Tasks released during Δ join the ready queue */
+	fixt_algo_advance(algo, delta);
 
-			elt->tk_r = elt->tk_r - delta;
-
-			log_iaft(4, elt);
-		}
-	}
 	log_fend(3, "rma_recalc");
 }
 
+#if FIXT_ALGO_STATIC_DISPATCH
+FIXT_ALGO_STATIC_STEP(fixt_algo_impl_rma)
+#endif
+
 struct fixt_algo* fixt_algo_impl_rma_new()
 {
 	AlgoHook al_init = &fixt_algo_impl_rma_init;
 	AlgoHook al_schedule = &fixt_algo_impl_rma_schedule;
 	AlgoHook al_block = &fixt_algo_impl_rma_block;
 	AlgoHook al_recalc = &fixt_algo_impl_rma_recalc;
+	AlgoKey al_key = &fixt_algo_impl_rma_key;
 
-	return fixt_algo_new(al_init, al_schedule, al_block, al_recalc, POLICY_RMA);
+	struct fixt_algo* algo = fixt_algo_new(al_init, al_schedule, al_block,
+			al_recalc, al_key, POLICY_RMA);
+	algo->al_name = "RMA";
+	algo->al_analyze = &fixt_algo_impl_rma_analyze;
+
+#if FIXT_ALGO_STATIC_DISPATCH
+	algo->al_step = &fixt_algo_impl_rma_step;
+#endif
+
+	return algo;
 }
 
-static int rma_comparator(void* l, void* r)
+/*
+ * Under RMA, a task's key is its period so that tasks with small periods
+ * have high priority. The key never changes between releases.
+ */
+int fixt_algo_impl_rma_key(struct fixt_algo* algo, struct fixt_task* task)
 {
-	struct fixt_task* task_l = (struct fixt_task*) l;
-	struct fixt_task* task_r = (struct fixt_task*) r;
-	/*
-	 * If the left task has a smaller period than the right task, then the
-	 * function will return a negative number, etc.
-	 */
-	return task_l->tk_p - task_r->tk_p;
+	return task->tk_p;
+}
+
+/*
+ * Tasks run to completion under our RMA, so use non-preemptive
+ * response-time analysis with rate monotonic priorities.
+ */
+enum fixt_verdict fixt_algo_impl_rma_analyze(struct fixt_set* set)
+{
+	return fixt_analysis_rm(set, false);
 }
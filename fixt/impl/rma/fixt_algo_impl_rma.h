@@ -14,6 +14,8 @@
 void fixt_algo_impl_rma_init(struct fixt_algo*);
 void fixt_algo_impl_rma_schedule(struct fixt_algo*);
 void fixt_algo_impl_rma_block(struct fixt_algo*);
+int fixt_algo_impl_rma_key(struct fixt_algo*, struct fixt_task*);
+enum fixt_verdict fixt_algo_impl_rma_analyze(struct fixt_set*);
 
 /*
  * Create a Rate Monotonic Analysis--based scheduling algorithm
@@ -9,24 +9,22 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <time.h>
-#include <errno.h>
 #include "utlist.h"
 #include "spin/spin.h"
+#include "plat/plat.h"
 #include "fixt/fixt_hook.h"
 #include "fixt/fixt_algo.h"
 #include "fixt/fixt_task.h"
 #include "fixt_algo_impl_sct.h"
 
+/* Bind the key into requeues at compile time (see fixt_algo_static.h) */
+#define FIXT_ALGO_STATIC_KEY fixt_algo_impl_sct_key
+#include "fixt/fixt_algo_static.h"
+
 #include "log/log.h"
 
 #define POLICY_SCT SCHED_FIFO /* SCT does not actually require RR! */
 
-/*
- * This comparator compares two tasks under SCT and generates an ordering
- * such that tasks with short completion times will have high priority.
- */
-static int sct_comparator(void*, void*);
-
 /*
  * SCT requires the fixture thread (self) and all child task threads to use a
  * FIFO policy. Since the scheduler manipulates thread priorities to align with
@@ -40,27 +38,18 @@ static int sct_comparator(void*, void*);
 void fixt_algo_impl_sct_init(struct fixt_algo* algo)
 {
 	pthread_t self = pthread_self();
-	pthread_setschedparam(self, POLICY_SCT, NULL);
+	plat_thread_policy(self, POLICY_SCT);
 }
 
 void fixt_algo_impl_sct_schedule(struct fixt_algo* algo)
 {
 	log_func(3, "sct_schedule");
 
-	/* Reset the queue so we can reschedule the tasks */
-	algo->al_queue_head = NULL;
-
-	/* Only consider tasks that are ready (r <= 0) */
-	struct fixt_task *elt;
-	DL_FOREACH2 (algo->al_tasks_head, elt, _at_next) {
-		if (fixt_task_get_r(elt) <= 0) {
-			log_rchk(4, elt);
-			DL_APPEND2(algo->al_queue_head, elt, _aq_prev, _aq_next);
-		}
-	}
-
-	/* Pull the task with the shortest period to the head of the queue */
-	DL_SORT2(algo->al_queue_head, (&sct_comparator), _aq_prev, _aq_next);
+	/*
+	 * Released tasks are kept in the ready queue by recalc, so the
+	 * task with the shortest completion time is already at the top of the heap.
+	 */
+	algo->al_queue_head = fixt_heap_peek(&algo->al_ready);
 
 	log_fend(3, "sct_schedule");
 }
@@ -78,13 +67,9 @@ void fixt_algo_impl_sct_block(struct fixt_algo* algo)
 {
 	log_func(3, "sct_block");
 
-	sem_t* sem_done = fixt_task_get_sem_done(algo->al_queue_head);
-	struct timespec abs_next;
-	abs_next = spin_abstime_in_quanta(SCT_PERIOD, SCT_JITTER);
-
-	if(sem_timedwait(sem_done, &abs_next) == 0) {
+	if(fixt_algo_wait(algo, SCT_PERIOD, SCT_JITTER)) {
 		log_msg(4, "[ Scheduler Resume b/c Task Completed ]");
-	} else if(errno == ETIMEDOUT) {
+	} else {
 		log_msg(4, "[ Scheduler Preemption ]");
 	}
 
@@ -92,15 +77,15 @@ void fixt_algo_impl_sct_block(struct fixt_algo* algo)
 }
 
 /*
- * Recalculate the r parameter across all tasks.
+ * Advance the release calendar past the last run.
  *
  * If a task actually ran this iteration, then the head of the queue will
- * be that task. If the queue head has completed its execution, then calculate
- * time until ready for the next period. Otherwise, all tasks were ready
- * SCT_PERIOD quanta ago.
+ * be that task. If the queue head has completed its execution, then its
+ * next job is released one period after the current one. Otherwise, it
+ * stays ready. Either way, time moved forward by SCT_PERIOD quanta.
  *
- * If no task ran, then all tasks must have their r parameter normalized to
- * zero based upon the smallest r parameter in the current task pool.
+ * If no task ran, then the scheduler idled until the earliest pending
+ * release. Only tasks released along the way are touched.
  */
 void fixt_algo_impl_sct_recalc(struct fixt_algo* algo)
 {
@@ -115,53 +100,52 @@ void fixt_algo_impl_sct_recalc(struct fixt_algo* algo)
 		delta = SCT_PERIOD;
 		head->tk_a += delta; /* Add one to the task's accumlated time */
 
-		if(fixt_task_completion_time(head) > 0) {
-			/* Still execution time left: task is still ready */
-			head->tk_r = head->tk_r - delta;
-		} else {
-			/* No execution time left: calculate time til next period */
-			head->tk_r = head->tk_p - delta + head->tk_r;
-			head->tk_a = 0; /* Reset accumulated time */
+		if(fixt_task_completion_time(head) <= 0) {
+			/* No execution time left: wait for the next period */
+			fixt_algo_retire(algo, head, algo->al_now + delta);
 		}
+		fixt_algo_requeue(algo, head);
 
 		log_haft(4, head);
 	} else {
-		/* Normalize all r parameters: Δ = min(ri) */
+		/* Skip ahead to the next release: Δ = min(ri) */
 		delta = fixt_algo_min_r(algo);
 	}
 
-	/* Tasks chosen to idle: r' = r - Δ */
-	struct fixt_task* elt;
-	DL_FOREACH2(algo->al_tasks_head, elt, _at_next) {
-		/* Don't do this calculation on the queue head! */
-		if (elt != head) {
-			log_ibef(4, elt);
-
-			elt->tk_r = elt->tk_r - delta;
+	/* Tasks released during Δ join the ready queue */
+	fixt_algo_advance(algo, delta);
 
-			log_iaft(4, elt);
-		}
-	}
 	log_fend(3, "sct_recalc");
 }
 
+#if FIXT_ALGO_STATIC_DISPATCH
+FIXT_ALGO_STATIC_STEP(fixt_algo_impl_sct)
+#endif
+
 struct fixt_algo* fixt_algo_impl_sct_new()
 {
 	AlgoHook al_init = &fixt_algo_impl_sct_init;
 	AlgoHook al_schedule = &fixt_algo_impl_sct_schedule;
 	AlgoHook al_block = &fixt_algo_impl_sct_block;
 	AlgoHook al_recalc = &fixt_algo_impl_sct_recalc;
+	AlgoKey al_key = &fixt_algo_impl_sct_key;
 
-	return fixt_algo_new(al_init, al_schedule, al_block, al_recalc, POLICY_SCT);
+	struct fixt_algo* algo = fixt_algo_new(al_init, al_schedule, al_block,
+			al_recalc, al_key, POLICY_SCT);
+	algo->al_name = "SCT";
+#if FIXT_ALGO_STATIC_DISPATCH
+	algo->al_step = &fixt_algo_impl_sct_step;
+#endif
+
+	return algo;
 }
 
-static int sct_comparator(void* l, void* r)
+/*
+ * Under SCT, a task's key is its completion time so that tasks with short
+ * completion times will have high priority. Only the head is ever charged,
+ * so it is the only task whose key changes from one quantum to the next.
+ */
+int fixt_algo_impl_sct_key(struct fixt_algo* algo, struct fixt_task* task)
 {
-	struct fixt_task* task_l = (struct fixt_task*) l;
-	struct fixt_task* task_r = (struct fixt_task*) r;
-	/*
-	 * If the left task has a shorter completion time than the right task,
-	 * then the function will return a negative number, etc.
-	 */
-	return fixt_task_completion_time(task_l) - fixt_task_completion_time(task_r);
+	return fixt_task_completion_time(task);
 }
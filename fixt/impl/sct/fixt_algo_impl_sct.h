@@ -17,6 +17,7 @@
 void fixt_algo_impl_sct_init(struct fixt_algo*);
 void fixt_algo_impl_sct_schedule(struct fixt_algo*);
 void fixt_algo_impl_sct_block(struct fixt_algo*);
+int fixt_algo_impl_sct_key(struct fixt_algo*, struct fixt_task*);
 
 /*
  * Create a Shortest Completion Time--based scheduling algorithm
@@ -0,0 +1,102 @@
+/*
+ * File: histogram.c
+ * Description: HDR-style latency histograms
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "plat/plat.h"
+#include "histogram.h"
+
+#define K_LOG_HIST_HALF (K_LOG_HIST_SUB / 2)
+#define K_LOG_HIST_SHIFT 7 /* log2(K_LOG_HIST_HALF) */
+
+static double hist_ns_per_cycle;
+static pthread_once_t hist_once = PTHREAD_ONCE_INIT;
+
+static void k_log_hist_calibrate(void)
+{
+	hist_ns_per_cycle = 1e9 / plat_cycles_per_sec();
+}
+
+/*
+ * Bucket of a value: the value itself while below K_LOG_HIST_SUB, then its
+ * top eight bits, K_LOG_HIST_HALF buckets to each power of two.
+ */
+static int k_log_hist_index(uint64_t v)
+{
+	if (v < K_LOG_HIST_SUB) return (int) v;
+
+	int shift = (63 - __builtin_clzll(v)) - K_LOG_HIST_SHIFT;
+	return K_LOG_HIST_SUB + (shift - 1) * K_LOG_HIST_HALF
+			+ (int) ((v >> shift) - K_LOG_HIST_HALF);
+}
+
+/*
+ * Largest value which falls into a bucket.
+ */
+static long long k_log_hist_upper(int index)
+{
+	if (index < K_LOG_HIST_SUB) return index;
+
+	int j = index - K_LOG_HIST_SUB;
+	int shift = j / K_LOG_HIST_HALF + 1;
+	long long sub = j % K_LOG_HIST_HALF + K_LOG_HIST_HALF;
+	return ((sub + 1) << shift) - 1;
+}
+
+void k_log_hist_clear(struct k_log_hist* hist)
+{
+	memset(hist, 0, sizeof(*hist));
+}
+
+void k_log_hist_add(struct k_log_hist* hist, long long ns)
+{
+	const long long top = (1LL << K_LOG_HIST_BITS) - 1;
+	if (ns < 0) ns = 0;
+	if (ns > hist->kh_max) hist->kh_max = ns;
+	if (ns > top) ns = top;
+
+	hist->kh_count[k_log_hist_index(ns)]++;
+	hist->kh_total++;
+}
+
+long long k_log_hist_percentile(struct k_log_hist* hist, double percent)
+{
+	if (!hist->kh_total) return 0;
+
+	/* The rank of the value wanted, counting from 1 */
+	uint64_t rank = (uint64_t) (percent / 100.0 * hist->kh_total + 0.5);
+	if (rank < 1) rank = 1;
+	if (rank > hist->kh_total) rank = hist->kh_total;
+
+	uint64_t seen = 0;
+	int i;
+	for (i = 0; i < K_LOG_HIST_BUCKETS; i++) {
+		seen += hist->kh_count[i];
+		if (seen >= rank) break;
+	}
+
+	/* No bucket bound says more than the largest value itself */
+	long long upper = k_log_hist_upper(i);
+	return upper < hist->kh_max ? upper : hist->kh_max;
+}
+
+void k_log_hist_print(const char* name, struct k_log_hist* hist)
+{
+	if (!hist->kh_total) return;
+
+	printf(" [ LATENCY %s ] n %llu us: p50 %.1f p99 %.1f p99.9 %.1f "
+			"max %.1f\n", name, (unsigned long long) hist->kh_total,
+			k_log_hist_percentile(hist, 50.0) / 1000.0,
+			k_log_hist_percentile(hist, 99.0) / 1000.0,
+			k_log_hist_percentile(hist, 99.9) / 1000.0,
+			hist->kh_max / 1000.0);
+}
+
+long long k_log_hist_now(void)
+{
+	pthread_once(&hist_once, &k_log_hist_calibrate);
+	return (long long) (plat_cycles() * hist_ns_per_cycle);
+}
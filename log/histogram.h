@@ -0,0 +1,59 @@
+/*
+ * File: histogram.h
+ * Description: HDR-style latency histograms
+ *
+ * A histogram counts ns durations in log-linear buckets: exact below
+ * K_LOG_HIST_SUB ns, then K_LOG_HIST_SUB / 2 buckets per power of two, so
+ * every recorded value is kept to within 1% (two significant digits) up to
+ * 2^K_LOG_HIST_BITS ns. Recording is an index computation and an increment,
+ * cheap enough to leave on for every scheduling decision of a run, and the
+ * buckets are fixed, so runs of any length cost the same memory.
+ */
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <stdint.h>
+
+#define K_LOG_HIST_SUB 256 /* Linear buckets below the first magnitude */
+#define K_LOG_HIST_BITS 40 /* Largest value kept: about 18 minutes in ns */
+#define K_LOG_HIST_BUCKETS \
+	(K_LOG_HIST_SUB + (K_LOG_HIST_BITS - 8) * (K_LOG_HIST_SUB / 2))
+
+struct k_log_hist
+{
+	uint64_t kh_count[K_LOG_HIST_BUCKETS];
+	uint64_t kh_total; /* Values recorded */
+	long long kh_max; /* Largest value recorded, exactly */
+};
+
+/*
+ * Forget every value recorded so far.
+ */
+void k_log_hist_clear(struct k_log_hist*);
+
+/*
+ * Record a duration in ns. Negative ones count as 0, and ones past the
+ * largest bucket count in it.
+ */
+void k_log_hist_add(struct k_log_hist*, long long ns);
+
+/*
+ * Return the value (in ns) at or below which the given percentage of the
+ * recorded values fall, rounded up to its bucket's upper bound, or 0 if
+ * nothing was recorded.
+ */
+long long k_log_hist_percentile(struct k_log_hist*, double percent);
+
+/*
+ * Print one line of p50, p99, p99.9 and max in us, labelled with name.
+ * Histograms with nothing recorded are not printed.
+ */
+void k_log_hist_print(const char* name, struct k_log_hist*);
+
+/*
+ * Return the cycle counter in ns, for timing what goes into histograms.
+ */
+long long k_log_hist_now(void);
+
+#endif
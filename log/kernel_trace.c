@@ -1,53 +1,459 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <time.h>
-#include <sys/neutrino.h>
-#include <sys/trace.h>
+#include <pthread.h>
+#include <sched.h>
+#include "plat/plat.h"
 #include "fixt/fixt_task.h"
 #include "kernel_trace.h"
+#include "trace_file.h"
 
-#define LOG_K_LENGTH 1000
-static struct timespec log_time[LOG_K_LENGTH];
-static int log_event[LOG_K_LENGTH];
-static int log_entry = 0;
+#define LOG_K_RING 4096 /* Events per thread between drains (power of two) */
+#define LOG_K_DRAIN_MS 10 /* Drain thread period */
+#define LOG_K_DRAIN_PRIO 6 /* Below FIXT_ALGO_MIN_PRIO: never displaces tasks */
 
-#define LOG_K_BEG 0
-#define LOG_K_END 1
+/*
+ * An event as logged by its thread. Stamps are raw clock cycles, unless the
+ * trace had a clock of its own (LOG_K_VIRTUAL), in which case they are ns.
+ */
+struct k_log_event
+{
+	uint64_t ke_stamp;
+	struct k_log_csv* ke_trace; /* Trace the thread was bound to */
+	int ke_event;
+	int ke_kind;
+};
+
+/*
+ * An event once drained into its trace.
+ */
+struct k_log_record
+{
+	long long kr_ns; /* CLOCK_MONOTONIC (or virtual) time of the event */
+	int kr_event;
+	int kr_kind;
+};
+
+struct k_log_csv
+{
+	struct k_log_record* kc_record; /* Drained events */
+	int kc_count;
+	int kc_cap;
+	unsigned kc_dropped; /* Events lost to a full ring */
+
+	void (*kc_clock)(void*, struct timespec*); /* NULL for clock cycles */
+	void* kc_clock_ctx;
+
+	struct k_log_file* kc_file; /* File drained records go on to, if any */
+	int kc_file_from; /* Records before this one stay in memory */
+	unsigned kc_file_dropped; /* kc_dropped when the file was attached */
+	struct k_log_csv* kc_stream_next;
+};
+
+/*
+ * Single-producer, single-consumer ring of one thread's events. Only the
+ * owning thread logs to it and only the drain (under log_drain_lock) reads
+ * from it, so neither side needs more than an acquire/release pair.
+ */
+struct k_log_ring
+{
+	struct k_log_event kr_event[LOG_K_RING];
+	unsigned kr_head; /* Next slot the owner fills */
+	unsigned kr_tail; /* Next slot the drain empties */
+	struct k_log_csv* kr_trace; /* Trace the owner logs to */
+	int kr_orphan; /* Owner exited: free once drained */
+	struct k_log_ring* kr_next;
+};
+
+static struct k_log_csv log_global;
+
+/* Per-thread ring, created once on first use */
+static pthread_key_t log_key;
+static pthread_once_t log_key_once = PTHREAD_ONCE_INIT;
+
+/* Every ring, and the drain of them into their traces */
+static struct k_log_ring* log_rings;
+static pthread_mutex_t log_drain_lock;
+static pthread_once_t log_drain_once = PTHREAD_ONCE_INIT;
+
+/* Traces streaming to a file, flushed after every drain */
+static struct k_log_csv* log_streams;
+
+/* Drain thread */
+static pthread_t log_drain_thread;
+static int log_drain_running;
+
+/* Cycle counter calibration, anchored to CLOCK_MONOTONIC */
+static uint64_t log_cps;
+static uint64_t log_anchor_cycles;
+static long long log_anchor_ns;
+
+#define LOG_K_VIRTUAL 2 /* Beside LOG_K_BEG or LOG_K_END in ke_kind */
+
+/*
+ * The drain thread holds the lock at LOG_K_DRAIN_PRIO, while a task whose
+ * ring fills waits on it from above; inheriting the task's priority, the
+ * drain can't be kept from finishing by anything in between.
+ */
+static void k_log_lock_init(void)
+{
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	pthread_mutex_init(&log_drain_lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+static void k_log_lock(void)
+{
+	pthread_once(&log_drain_once, &k_log_lock_init);
+	pthread_mutex_lock(&log_drain_lock);
+}
+
+static void k_log_ring_exit(void* arg)
+{
+	struct k_log_ring* ring = (struct k_log_ring*) arg;
+	__atomic_store_n(&ring->kr_orphan, 1, __ATOMIC_RELEASE);
+}
+
+static void k_log_key_create(void)
+{
+	pthread_key_create(&log_key, &k_log_ring_exit);
+
+	struct timespec ts;
+	log_cps = plat_cycles_per_sec();
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	log_anchor_cycles = plat_cycles();
+	log_anchor_ns = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static struct k_log_ring* k_log_ring_new(void)
+{
+	struct k_log_ring* ring = calloc(1, sizeof(struct k_log_ring));
+	ring->kr_trace = &log_global;
+	pthread_setspecific(log_key, ring);
+
+	k_log_lock();
+	ring->kr_next = log_rings;
+	log_rings = ring;
+	pthread_mutex_unlock(&log_drain_lock);
+
+	return ring;
+}
+
+static struct k_log_ring* k_log_ring_this(void)
+{
+	pthread_once(&log_key_once, &k_log_key_create);
+	struct k_log_ring* ring = pthread_getspecific(log_key);
+	return ring ? ring : k_log_ring_new();
+}
+
+static struct k_log_csv* k_log_csv_this(void)
+{
+	pthread_once(&log_key_once, &k_log_key_create);
+	struct k_log_ring* ring = pthread_getspecific(log_key);
+	return ring ? ring->kr_trace : &log_global;
+}
+
+struct k_log_csv* k_log_csv_new(void)
+{
+	return calloc(1, sizeof(struct k_log_csv));
+}
+
+void k_log_csv_del(struct k_log_csv* log)
+{
+	if (!log) return; /* The global buffer is never deleted */
+
+	/* No ring may still hold an event for it */
+	k_log_csv_stream(log, NULL);
+	free(log->kc_record);
+	free(log);
+}
+
+void k_log_csv_bind(struct k_log_csv* log)
+{
+	pthread_once(&log_key_once, &k_log_key_create);
+	struct k_log_ring* ring = pthread_getspecific(log_key);
+	if (!ring) {
+		if (!log) return; /* Already on the global buffer */
+		ring = k_log_ring_new();
+	}
+	ring->kr_trace = log ? log : &log_global;
+}
+
+struct k_log_csv* k_log_csv_current(void)
+{
+	struct k_log_csv* log = k_log_csv_this();
+	return log == &log_global ? NULL : log;
+}
+
+void k_log_set_clock(void (*clock)(void*, struct timespec*), void* ctx)
+{
+	struct k_log_csv* log = k_log_csv_this();
+	log->kc_clock = clock;
+	log->kc_clock_ctx = ctx;
+}
+
+/*
+ * Log an event to the calling thread's ring: a cycle counter read and a
+ * handful of stores. A full ring is emptied on the spot if the trace runs
+ * on a virtual clock, where waiting costs the run nothing, or streams to a
+ * file, which has room for every event. Otherwise the event is dropped and
+ * counted, rather than stall a job on the real clock.
+ */
+static void k_log_push(int c, int kind)
+{
+	struct k_log_ring* ring = k_log_ring_this();
+	struct k_log_csv* log = ring->kr_trace;
+
+	unsigned head = ring->kr_head;
+	if (head - __atomic_load_n(&ring->kr_tail, __ATOMIC_ACQUIRE)
+			== LOG_K_RING) {
+		if (!log->kc_clock && !log->kc_file) {
+			__atomic_add_fetch(&log->kc_dropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+		k_log_drain();
+	}
+
+	struct k_log_event* ev = &ring->kr_event[head & (LOG_K_RING - 1)];
+	if (log->kc_clock) {
+		struct timespec ts;
+		log->kc_clock(log->kc_clock_ctx, &ts);
+		ev->ke_stamp = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+		kind |= LOG_K_VIRTUAL;
+	} else {
+		ev->ke_stamp = plat_cycles();
+	}
+	ev->ke_trace = log;
+	ev->ke_event = c;
+	ev->ke_kind = kind;
+
+	__atomic_store_n(&ring->kr_head, head + 1, __ATOMIC_RELEASE);
+}
 
 void k_log_start(int c)
 {
-	TraceEvent(_NTO_TRACE_INSERTUSRSTREVENT, c, "beg");
+	plat_trace(c, "beg");
 }
 
 void k_log_end(int c)
 {
-	TraceEvent(_NTO_TRACE_INSERTUSRSTREVENT, c, "end");
+	plat_trace(c, "end");
 }
 
 void k_log_csv_start(int c)
 {
-	if (log_entry < LOG_K_LENGTH) {
-		log_event[log_entry] = c;
-		clock_gettime(CLOCK_REALTIME, &log_time[log_entry]);
+	k_log_push(c, LOG_K_BEG);
+}
+
+void k_log_csv_end(int c)
+{
+	k_log_push(c, LOG_K_END);
+}
+
+static long long k_log_ns(struct k_log_event* ev)
+{
+	if (ev->ke_kind & LOG_K_VIRTUAL) return ev->ke_stamp;
 
-		log_entry++;
+	/* Split the division so that long runs can't overflow */
+	int64_t cycles = (int64_t) (ev->ke_stamp - log_anchor_cycles);
+	int64_t sec = cycles / (int64_t) log_cps;
+	int64_t rem = cycles % (int64_t) log_cps;
+	return log_anchor_ns + sec * 1000000000LL
+			+ rem * 1000000000LL / (int64_t) log_cps;
+}
+
+static void k_log_record(struct k_log_event* ev)
+{
+	struct k_log_csv* log = ev->ke_trace;
+	if (log->kc_count == log->kc_cap) {
+		log->kc_cap = log->kc_cap ? 2 * log->kc_cap : LOG_K_RING;
+		log->kc_record = realloc(log->kc_record,
+				log->kc_cap * sizeof(struct k_log_record));
 	}
+
+	struct k_log_record* rec = &log->kc_record[log->kc_count++];
+	rec->kr_ns = k_log_ns(ev);
+	rec->kr_event = ev->ke_event;
+	rec->kr_kind = ev->ke_kind & ~LOG_K_VIRTUAL;
 }
 
-void k_log_csv_end(int c)
+/*
+ * Put the records of a trace from the given one on in time order. Each
+ * thread's events arrive in order, but threads are drained one after
+ * another. Records are therefore nearly sorted already, and an insertion
+ * sort puts them in order in close to one pass.
+ */
+static void k_log_csv_sort(struct k_log_csv* log, int from)
+{
+	int i, j;
+	struct k_log_record* rec = log->kc_record;
+	for (i = from + 1; i < log->kc_count; i++) {
+		struct k_log_record r = rec[i];
+		for (j = i; j > from && rec[j - 1].kr_ns > r.kr_ns; j--) {
+			rec[j] = rec[j - 1];
+		}
+		rec[j] = r;
+	}
+}
+
+/*
+ * Move the records drained since a trace started streaming to its file.
+ */
+static void k_log_csv_flush(struct k_log_csv* log)
 {
-	if (log_entry < LOG_K_LENGTH) {
-		log_event[log_entry] = c;
-		clock_gettime(CLOCK_REALTIME, &log_time[log_entry]);
+	k_log_csv_sort(log, log->kc_file_from);
 
-		log_entry++;
+	int i;
+	for (i = log->kc_file_from; i < log->kc_count; i++) {
+		struct k_log_record* rec = &log->kc_record[i];
+		k_log_file_append(log->kc_file, rec->kr_ns, rec->kr_event,
+				rec->kr_kind);
 	}
+	log->kc_count = log->kc_file_from;
 }
 
-void k_log_csv_print()
+/*
+ * Empty every ring into its traces. Call with log_drain_lock held.
+ */
+static void k_log_drain_locked(void)
+{
+	struct k_log_ring** link = &log_rings;
+	while (*link) {
+		struct k_log_ring* ring = *link;
+
+		/* Read the orphan flag first: an orphan logs no more events */
+		int orphan = __atomic_load_n(&ring->kr_orphan, __ATOMIC_ACQUIRE);
+		unsigned head = __atomic_load_n(&ring->kr_head, __ATOMIC_ACQUIRE);
+		unsigned tail = ring->kr_tail;
+		for (; tail != head; tail++) {
+			k_log_record(&ring->kr_event[tail & (LOG_K_RING - 1)]);
+		}
+		__atomic_store_n(&ring->kr_tail, tail, __ATOMIC_RELEASE);
+
+		if (orphan) {
+			*link = ring->kr_next;
+			free(ring);
+		} else {
+			link = &ring->kr_next;
+		}
+	}
+
+	struct k_log_csv* log;
+	for (log = log_streams; log; log = log->kc_stream_next) {
+		k_log_csv_flush(log);
+	}
+}
+
+void k_log_drain(void)
+{
+	k_log_lock();
+	k_log_drain_locked();
+	pthread_mutex_unlock(&log_drain_lock);
+}
+
+void k_log_csv_stream(struct k_log_csv* log, struct k_log_file* file)
 {
+	if (!log) log = &log_global;
+
+	/* Events logged so far go where they were headed */
+	k_log_lock();
+	k_log_drain_locked();
+
+	if (log->kc_file) {
+		/* The file's header tells readers what it is missing */
+		unsigned dropped = __atomic_load_n(&log->kc_dropped, __ATOMIC_RELAXED);
+		k_log_file_drop(log->kc_file, dropped - log->kc_file_dropped);
+
+		struct k_log_csv** link = &log_streams;
+		while (*link != log) link = &(*link)->kc_stream_next;
+		*link = log->kc_stream_next;
+	}
+	log->kc_file = file;
+	log->kc_file_from = log->kc_count;
+	log->kc_file_dropped = __atomic_load_n(&log->kc_dropped, __ATOMIC_RELAXED);
+	if (file) {
+		log->kc_stream_next = log_streams;
+		log_streams = log;
+	}
+	pthread_mutex_unlock(&log_drain_lock);
+}
+
+static void* k_log_drain_main(void* arg)
+{
+	struct timespec period = { 0, LOG_K_DRAIN_MS * 1000000L };
+	while (__atomic_load_n(&log_drain_running, __ATOMIC_ACQUIRE)) {
+		k_log_drain();
+		nanosleep(&period, NULL);
+	}
+	return NULL;
+}
+
+void k_log_drain_start(void)
+{
+	if (__atomic_exchange_n(&log_drain_running, 1, __ATOMIC_ACQ_REL)) {
+		return; /* Already draining */
+	}
+
+	/*
+	 * Drain below every task thread, so that the drain only ever runs on
+	 * time the schedule under test leaves idle. A ring fills in well under
+	 * a test of a busy set, so traces which can't afford to drop events
+	 * have their producers drain as well (see k_log_push()).
+	 */
+	pthread_attr_t attr;
+	struct sched_param param;
+	pthread_attr_init(&attr);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	param.sched_priority = LOG_K_DRAIN_PRIO;
+	pthread_attr_setschedparam(&attr, &param);
+
+	if (pthread_create(&log_drain_thread, &attr, &k_log_drain_main, NULL)) {
+		__atomic_store_n(&log_drain_running, 0, __ATOMIC_RELEASE);
+	} else {
+		pthread_setname_np(log_drain_thread, "k_log_drain");
+	}
+	pthread_attr_destroy(&attr);
+}
+
+void k_log_drain_stop(void)
+{
+	if (__atomic_exchange_n(&log_drain_running, 0, __ATOMIC_ACQ_REL)) {
+		pthread_join(log_drain_thread, NULL);
+	}
+	k_log_drain();
+}
+
+unsigned k_log_csv_dropped(struct k_log_csv* log)
+{
+	if (!log) log = &log_global;
+	return __atomic_load_n(&log->kc_dropped, __ATOMIC_RELAXED);
+}
+
+void k_log_csv_print_trace(struct k_log_csv* log)
+{
+	k_log_lock();
+	k_log_drain_locked();
+
+	k_log_csv_sort(log, 0);
+
 	int i;
-	for (i = 0; i < LOG_K_LENGTH; i++) {
-		struct timespec ti = log_time[i];
-		printf("%d, %d, %d, %ld\n", i, log_event[i], ti.tv_sec, ti.tv_nsec);
+	struct k_log_record* rec = log->kc_record;
+	for (i = 0; i < log->kc_count; i++) {
+		printf("%d, %d, %lld, %lld\n", i, rec[i].kr_event,
+				rec[i].kr_ns / 1000000000LL, rec[i].kr_ns % 1000000000LL);
 	}
+	if (log->kc_dropped) {
+		fprintf(stderr, "k_log: %u events dropped\n", log->kc_dropped);
+	}
+	pthread_mutex_unlock(&log_drain_lock);
+}
+
+void k_log_csv_print()
+{
+	k_log_csv_print_trace(&log_global);
 }
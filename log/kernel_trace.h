@@ -1,8 +1,16 @@
 #ifndef LOG_K_
 #define LOG_K_
 
+#include <time.h>
+
 #define LOG_K_ALGO 20 /* Higher than the number of tasks in a given set */
 #define LOG_K_FIXT 21
+#define LOG_K_RELEASE 22 /* Scheduler phases after LOG_K_ALGO (scheduling) */
+#define LOG_K_RECALC 23
+#define LOG_K_ARRIVAL 32 /* Plus a task id: a job of it was released (BEG) */
+
+#define LOG_K_BEG 0 /* Kinds of event */
+#define LOG_K_END 1
 
 void k_log_start(int c);
 void k_log_end(int c);
@@ -11,7 +19,77 @@ void k_log_csv_start(int c);
 void k_log_csv_end(int c);
 void k_log_csv_print(void);
 
+/*
+ * A CSV trace buffer. Threads log to the global buffer unless they bind
+ * their own, which lets concurrent test runs keep their events apart.
+ *
+ * Each thread logs into a ring of its own, stamping events with the cycle
+ * counter, so that logging takes no lock and no system call. Rings are
+ * emptied into their traces by the drain thread, or by k_log_drain(). A
+ * thread whose ring fills empties the rings itself if its trace has a
+ * clock of its own or streams to a file; otherwise the event is dropped and
+ * counted in its trace.
+ */
+struct k_log_csv;
+
+struct k_log_csv* k_log_csv_new(void);
+void k_log_csv_del(struct k_log_csv*);
+
+/*
+ * Direct the calling thread's CSV events to the given buffer. Passing NULL
+ * restores the global buffer.
+ */
+void k_log_csv_bind(struct k_log_csv*);
+
+/*
+ * Return the buffer the calling thread logs to (NULL if the global one)
+ */
+struct k_log_csv* k_log_csv_current(void);
+
+/*
+ * Print a trace as CSV in time order, after draining every ring.
+ */
+void k_log_csv_print_trace(struct k_log_csv*);
+
+/*
+ * Send the events a trace gets from now on to a binary trace file rather
+ * than keeping them in memory, or stop doing so if file is NULL. Records
+ * already in memory stay there. The file is left open, with the events
+ * the trace dropped in the meantime counted in its header.
+ */
+struct k_log_file;
+void k_log_csv_stream(struct k_log_csv*, struct k_log_file*);
+
+/*
+ * Return the number of events a trace lost to full rings (NULL: global)
+ */
+unsigned k_log_csv_dropped(struct k_log_csv*);
+
+/*
+ * Empty every thread's ring into its traces now.
+ */
+void k_log_drain(void);
+
+/*
+ * Start and stop the low priority thread which periodically empties rings.
+ * Stopping drains whatever is left.
+ */
+void k_log_drain_start(void);
+void k_log_drain_stop(void);
+
+/*
+ * Stamp the calling thread's CSV events with a different clock, e.g. the
+ * virtual clock of a simulated run. Passing NULL restores the cycle counter.
+ */
+void k_log_set_clock(void (*clock)(void*, struct timespec*), void* ctx);
+
+/*
+ * How k_log_s() and k_log_e() record: 1 into the instrumentation events,
+ * 2 into the CSV rings, 0 not at all.
+ */
+#ifndef LOG_K_METHOD
 #define LOG_K_METHOD 2
+#endif
 
 #if LOG_K_METHOD == 1
 #define k_log_s(t) k_log_start(t)
@@ -19,29 +19,31 @@ void log_fend_f(int indent, char* fun)
 void log_rchk_f(int indent, struct fixt_task* task)
 {
 	printf("%s rchk (%d, %d, %d: %d)\n", dots[indent], task->tk_c, task->tk_p,
-			task->tk_d, task->tk_r);
+			task->tk_d, task->tk_release);
 }
 
 void log_hbef_f(int indent, struct fixt_task* task)
 {
 	printf("%s head (%d, %d, %d: %d) -> ", dots[indent], task->tk_c, task->tk_p,
-			task->tk_d, task->tk_r);
+			task->tk_d, task->tk_release);
 }
 
 void log_haft_f(int indent, struct fixt_task* task)
 {
-	printf("(%d, %d, %d: %d)\n", task->tk_c, task->tk_p, task->tk_d, task->tk_r);
+	printf("(%d, %d, %d: %d)\n", task->tk_c, task->tk_p, task->tk_d,
+			task->tk_release);
 }
 
 void log_ibef_f(int indent, struct fixt_task* task)
 {
 	printf("%s idle (%d, %d, %d: %d) -> ", dots[indent], task->tk_c, task->tk_p,
-			task->tk_d, task->tk_r);
+			task->tk_d, task->tk_release);
 }
 
 void log_iaft_f(int indent, struct fixt_task* task)
 {
-	printf("(%d, %d, %d: %d)\n", task->tk_c, task->tk_p, task->tk_d, task->tk_r);
+	printf("(%d, %d, %d: %d)\n", task->tk_c, task->tk_p, task->tk_d,
+			task->tk_release);
 }
 
 void log_msg_f(int indent, char* msg) {
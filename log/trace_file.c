@@ -0,0 +1,235 @@
+/*
+ * File: trace_file.c
+ * Description: Compact binary k_log trace files
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace_file.h"
+
+struct k_log_file
+{
+	int kf_fd;
+	bool kf_writing;
+	bool kf_failed; /* A window couldn't be mapped: drop further events */
+
+	unsigned char* kf_map; /* Window of the file mapped at kf_base */
+	off_t kf_base;
+	size_t kf_len; /* Bytes mapped */
+	size_t kf_pos; /* Next byte within the window */
+	off_t kf_end; /* End of the events (reading) */
+
+	long long kf_last_ns; /* Time of the previous event */
+	struct k_log_file_header kf_header;
+	struct k_log_file_task* kf_tasks;
+};
+
+static off_t k_log_file_data(const struct k_log_file_header* header)
+{
+	return sizeof(*header) + header->fh_ntasks * sizeof(struct k_log_file_task);
+}
+
+/*
+ * Slide the window to the given file offset (a multiple of the window).
+ */
+static bool k_log_file_map(struct k_log_file* file, off_t base)
+{
+	if (file->kf_map) munmap(file->kf_map, file->kf_len);
+	file->kf_map = NULL;
+	file->kf_base = base;
+	file->kf_pos = 0;
+
+	if (file->kf_writing) {
+		file->kf_len = K_LOG_FILE_WINDOW;
+		if (ftruncate(file->kf_fd, base + K_LOG_FILE_WINDOW)) return false;
+	} else {
+		if (base >= file->kf_end) return false;
+		off_t left = file->kf_end - base;
+		file->kf_len = left < K_LOG_FILE_WINDOW ? left : K_LOG_FILE_WINDOW;
+	}
+
+	int prot = file->kf_writing ? PROT_READ | PROT_WRITE : PROT_READ;
+	void* map = mmap(NULL, file->kf_len, prot, MAP_SHARED, file->kf_fd, base);
+	if (map == MAP_FAILED) return false;
+	file->kf_map = map;
+	return true;
+}
+
+static void k_log_file_put(struct k_log_file* file, unsigned char byte)
+{
+	if (file->kf_failed) return;
+	if (file->kf_pos == file->kf_len
+			&& !k_log_file_map(file, file->kf_base + file->kf_len)) {
+		file->kf_failed = true;
+		return;
+	}
+	file->kf_map[file->kf_pos++] = byte;
+}
+
+static bool k_log_file_get(struct k_log_file* file, unsigned char* byte)
+{
+	if (file->kf_base + (off_t) file->kf_pos == file->kf_end) return false;
+	if (file->kf_pos == file->kf_len
+			&& !k_log_file_map(file, file->kf_base + file->kf_len)) {
+		return false;
+	}
+	*byte = file->kf_map[file->kf_pos++];
+	return true;
+}
+
+static void k_log_file_put_varint(struct k_log_file* file, uint64_t v)
+{
+	while (v >= 0x80) {
+		k_log_file_put(file, (unsigned char) (v | 0x80));
+		v >>= 7;
+	}
+	k_log_file_put(file, (unsigned char) v);
+}
+
+static bool k_log_file_get_varint(struct k_log_file* file, uint64_t* v)
+{
+	unsigned char byte;
+	int shift = 0;
+	*v = 0;
+	do {
+		if (shift > 63 || !k_log_file_get(file, &byte)) return false;
+		*v |= (uint64_t) (byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+	return true;
+}
+
+struct k_log_file* k_log_file_create(const char* path,
+		const struct k_log_file_header* header,
+		const struct k_log_file_task* tasks)
+{
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return NULL;
+
+	struct k_log_file* file = calloc(1, sizeof(*file));
+	file->kf_fd = fd;
+	file->kf_writing = true;
+	file->kf_header = *header;
+	memcpy(file->kf_header.fh_magic, K_LOG_FILE_MAGIC, 4);
+	file->kf_header.fh_version = K_LOG_FILE_VERSION;
+	file->kf_header.fh_events = 0;
+	file->kf_header.fh_dropped = 0;
+	file->kf_header.fh_bytes = 0;
+
+	/* The header and task table go first, in the first window */
+	if (!k_log_file_map(file, 0)) {
+		k_log_file_close(file);
+		return NULL;
+	}
+	const unsigned char* bytes = (const unsigned char*) &file->kf_header;
+	size_t i;
+	for (i = 0; i < sizeof(file->kf_header); i++) {
+		k_log_file_put(file, bytes[i]);
+	}
+	bytes = (const unsigned char*) tasks;
+	for (i = 0; i < header->fh_ntasks * sizeof(*tasks); i++) {
+		k_log_file_put(file, bytes[i]);
+	}
+	return file;
+}
+
+void k_log_file_append(struct k_log_file* file, long long ns, int event,
+		int kind)
+{
+	/* Zigzag, so that the odd out of order event stays short */
+	int64_t delta = ns - file->kf_last_ns;
+	file->kf_last_ns = ns;
+
+	k_log_file_put_varint(file, ((uint64_t) delta << 1) ^ (delta >> 63));
+	k_log_file_put_varint(file, ((uint64_t) event << 1) | (kind & 1));
+	if (!file->kf_failed) file->kf_header.fh_events++;
+}
+
+void k_log_file_drop(struct k_log_file* file, uint64_t events)
+{
+	file->kf_header.fh_dropped += events;
+}
+
+struct k_log_file* k_log_file_open(const char* path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+
+	struct k_log_file* file = calloc(1, sizeof(*file));
+	file->kf_fd = fd;
+
+	struct k_log_file_header* header = &file->kf_header;
+	if (pread(fd, header, sizeof(*header), 0) != sizeof(*header)
+			|| memcmp(header->fh_magic, K_LOG_FILE_MAGIC, 4)
+			|| header->fh_version != K_LOG_FILE_VERSION
+			|| header->fh_ntasks < 0) {
+		k_log_file_close(file);
+		return NULL;
+	}
+
+	size_t size = header->fh_ntasks * sizeof(struct k_log_file_task);
+	file->kf_tasks = malloc(size ? size : 1);
+	if (pread(fd, file->kf_tasks, size, sizeof(*header)) != (ssize_t) size) {
+		k_log_file_close(file);
+		return NULL;
+	}
+
+	/* Windows stay aligned to the file, so the first holds the header */
+	off_t data = k_log_file_data(header);
+	file->kf_end = data + header->fh_bytes;
+	off_t base = data - data % K_LOG_FILE_WINDOW;
+	if (file->kf_end > data && !k_log_file_map(file, base)) {
+		k_log_file_close(file);
+		return NULL;
+	}
+	file->kf_base = base;
+	file->kf_pos = data - base;
+	return file;
+}
+
+const struct k_log_file_header* k_log_file_header(struct k_log_file* file)
+{
+	return &file->kf_header;
+}
+
+const struct k_log_file_task* k_log_file_tasks(struct k_log_file* file)
+{
+	return file->kf_tasks;
+}
+
+bool k_log_file_next(struct k_log_file* file, long long* ns, int* event,
+		int* kind)
+{
+	uint64_t delta, word;
+	if (!k_log_file_get_varint(file, &delta)) return false;
+	if (!k_log_file_get_varint(file, &word)) return false;
+
+	file->kf_last_ns += (int64_t) (delta >> 1) ^ -(int64_t) (delta & 1);
+	*ns = file->kf_last_ns;
+	*event = (int) (word >> 1);
+	*kind = (int) (word & 1);
+	return true;
+}
+
+void k_log_file_close(struct k_log_file* file)
+{
+	off_t end = file->kf_base + file->kf_pos;
+	if (file->kf_map) munmap(file->kf_map, file->kf_len);
+
+	if (file->kf_writing) {
+		/* Trim the last window and fill in what the header couldn't know */
+		struct k_log_file_header* header = &file->kf_header;
+		off_t data = k_log_file_data(header);
+		header->fh_bytes = end > data ? end - data : 0;
+		ftruncate(file->kf_fd, data + header->fh_bytes);
+		pwrite(file->kf_fd, header, sizeof(*header), 0);
+	}
+
+	close(file->kf_fd);
+	free(file->kf_tasks);
+	free(file);
+}
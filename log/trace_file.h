@@ -0,0 +1,93 @@
+/*
+ * File: trace_file.h
+ * Description: Compact binary k_log trace files
+ *
+ * A trace file is a header describing the run, the table of its tasks, then
+ * its events. Each event is two varints: the zigzag-encoded ns since the
+ * previous event, and the event id shifted once left over its kind
+ * (LOG_K_BEG or LOG_K_END). Job releases are events of their own
+ * (LOG_K_ARRIVAL), so a reader never has to infer them. Files are written
+ * and read through a memory map sliding over K_LOG_FILE_WINDOW bytes at a
+ * time, so neither side ever holds more than that much of a trace, however
+ * long the run.
+ */
+
+#ifndef TRACE_FILE_H_
+#define TRACE_FILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define K_LOG_FILE_MAGIC "KLOG"
+#define K_LOG_FILE_VERSION 2
+#define K_LOG_FILE_NAME 16 /* Bytes for the algo name, with its NUL */
+#define K_LOG_FILE_WINDOW (1 << 20) /* Bytes mapped at once */
+
+struct k_log_file_header
+{
+	char fh_magic[4];
+	uint32_t fh_version;
+	uint64_t fh_events; /* Events in the file, set when it is closed */
+	uint64_t fh_dropped; /* Events lost before the file, set likewise */
+	uint64_t fh_bytes; /* Bytes of events following the task table */
+	int64_t fh_quantum_ns; /* Width of a scheduling quantum */
+	int32_t fh_virtual; /* Times are of a simulated run's virtual clock */
+	int32_t fh_cores; /* Cores the algo dispatched onto */
+	int32_t fh_set; /* Id of the task set */
+	int32_t fh_ntasks; /* Entries in the task table */
+	char fh_algo[K_LOG_FILE_NAME]; /* Name of the algo */
+};
+
+struct k_log_file_task
+{
+	int32_t ft_id;
+	int32_t ft_c;
+	int32_t ft_p;
+	int32_t ft_d;
+};
+
+struct k_log_file;
+
+/*
+ * Create a trace file for writing, starting with the given header (of
+ * which fh_magic, fh_version, fh_events, fh_dropped and fh_bytes are
+ * filled in) and
+ * fh_ntasks tasks. Returns NULL if the file can't be created or mapped.
+ */
+struct k_log_file* k_log_file_create(const char* path,
+		const struct k_log_file_header*, const struct k_log_file_task*);
+
+/*
+ * Append an event at the given time in ns. Events should come in time
+ * order; a slightly earlier one only costs a byte or so more.
+ */
+void k_log_file_append(struct k_log_file*, long long ns, int event, int kind);
+
+/*
+ * Count events of the run which never reached the file, e.g. lost to a
+ * full k_log ring. Readers can't trust a trace with any.
+ */
+void k_log_file_drop(struct k_log_file*, uint64_t events);
+
+/*
+ * Open a trace file for reading. Returns NULL if it can't be opened or
+ * isn't a trace file of this version.
+ */
+struct k_log_file* k_log_file_open(const char* path);
+
+const struct k_log_file_header* k_log_file_header(struct k_log_file*);
+const struct k_log_file_task* k_log_file_tasks(struct k_log_file*);
+
+/*
+ * Read the next event of a file opened for reading. Returns false at the
+ * end of the trace.
+ */
+bool k_log_file_next(struct k_log_file*, long long* ns, int* event,
+		int* kind);
+
+/*
+ * Finish a file (filling in its header, if writing) and close it.
+ */
+void k_log_file_close(struct k_log_file*);
+
+#endif
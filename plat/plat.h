@@ -0,0 +1,91 @@
+/*
+ * File: plat.h
+ * Description: Operating system services the fixture needs from its host
+ *
+ * Everything the fixture asks of the OS beyond POSIX goes through here:
+ * the cycle counter, the timer resolution, real-time thread setup, kernel
+ * tracing and processor affinity. plat_qnx.c implements it for QNX Neutrino
+ * and plat_linux.c for Linux (best with PREEMPT_RT); each compiles to
+ * nothing on the other, so both can sit in the source path.
+ */
+
+#ifndef PLAT_H_
+#define PLAT_H_
+
+#include <stdint.h>
+#include <pthread.h>
+
+/*
+ * Return a free-running counter which ticks plat_cycles_per_sec() times a
+ * second, as cheaply as the host allows.
+ */
+uint64_t plat_cycles(void);
+uint64_t plat_cycles_per_sec(void);
+
+/*
+ * How far plat_cycles_per_sec() can be trusted on the host's cores.
+ */
+enum plat_cycles_rate
+{
+	PLAT_CYCLES_NS, /* The counter is the monotonic clock in nanoseconds */
+	PLAT_CYCLES_INVARIANT, /* One constant rate, the same on every core */
+	PLAT_CYCLES_PER_CPU, /* Rates may differ between cores and drift */
+};
+
+enum plat_cycles_rate plat_cycles_rate(void);
+
+/*
+ * Ask for timers (sleeps and timed waits) to fire within ns of their time.
+ * Hosts with high resolution timers ignore this.
+ */
+void plat_clock_resolution(long ns);
+
+/*
+ * Prepare the process to run real-time threads: privileges, and memory
+ * locked so that no page fault ever lands inside a measured job.
+ */
+void plat_rt_init(void);
+
+/*
+ * Change a thread's scheduling policy, keeping its priority.
+ */
+void plat_thread_policy(pthread_t, int policy);
+
+/*
+ * Have the kernel schedule the calling thread by EDF, under a constant
+ * bandwidth server granting it runtime_ns of every period_ns, each job due
+ * deadline_ns into its period. sched_yield() then ends the current job,
+ * until the next period. Returns 0, or -1 with errno set if the host has
+ * no such scheduling class (ENOSYS) or can't admit the thread (EBUSY).
+ */
+int plat_thread_deadline(long long runtime_ns, long long deadline_ns,
+		long long period_ns);
+
+/*
+ * Insert a user event into the kernel trace, where the OS's own trace tools
+ * line it up with context switches.
+ */
+void plat_trace(int event, const char* what);
+
+/*
+ * Return the number of processors on the host.
+ */
+int plat_cpu_count(void);
+
+/*
+ * Restrict a thread of this process to the processors set in mask.
+ */
+void plat_cpu_mask(pthread_t, unsigned mask);
+
+/*
+ * Return the processor the calling thread is running on, or -1.
+ */
+int plat_cpu_current(void);
+
+/*
+ * Describe processor cpu by its model and frequency governor (what its
+ * clock rate depends on) in buf, as one line of at most len - 1 chars.
+ */
+void plat_cpu_describe(int cpu, char* buf, int len);
+
+#endif
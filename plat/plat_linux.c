@@ -0,0 +1,288 @@
+/*
+ * File: plat_linux.c
+ * Description: Host services on Linux
+ */
+
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "plat.h"
+
+/* On x86 the counter is the time stamp counter, read in user space */
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PLAT_TSC 1
+#else
+#define PLAT_TSC 0
+#endif
+
+/* How long to watch the time stamp counter against the monotonic clock */
+#define PLAT_TSC_MEASURE_MS 100
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+/*
+ * The argument of sched_setattr(2), which libcs have long left undeclared
+ */
+struct plat_sched_attr
+{
+	uint32_t size;
+	uint32_t sched_policy;
+	uint64_t sched_flags;
+	int32_t sched_nice;
+	uint32_t sched_priority;
+	uint64_t sched_runtime;
+	uint64_t sched_deadline;
+	uint64_t sched_period;
+};
+
+/* Where tracefs may be mounted, newest first */
+static const char* plat_marker_paths[] = {
+	"/sys/kernel/tracing/trace_marker",
+	"/sys/kernel/debug/tracing/trace_marker",
+};
+
+static int plat_marker = -1;
+static pthread_once_t plat_marker_once = PTHREAD_ONCE_INIT;
+
+static void plat_marker_open(void)
+{
+	int i;
+	int n = sizeof(plat_marker_paths) / sizeof(plat_marker_paths[0]);
+	for (i = 0; i < n && plat_marker < 0; i++) {
+		plat_marker = open(plat_marker_paths[i], O_WRONLY | O_CLOEXEC);
+	}
+}
+
+static uint64_t plat_mono_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#if PLAT_TSC
+static uint64_t plat_tsc_hz;
+static pthread_once_t plat_tsc_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Read the monotonic clock and the counter at (nearly) the same time: the
+ * counter between two reads of the clock, the tightest of a few tries.
+ */
+static void plat_tsc_sample(uint64_t* mono_ns, uint64_t* cycles)
+{
+	uint64_t best = UINT64_MAX;
+	int i;
+	for (i = 0; i < 8; i++) {
+		uint64_t a = plat_mono_ns();
+		uint64_t c = plat_cycles();
+		uint64_t b = plat_mono_ns();
+		if (b - a < best) {
+			best = b - a;
+			*mono_ns = a + (b - a) / 2;
+			*cycles = c;
+		}
+	}
+}
+
+/*
+ * Linux doesn't tell user space the rate of the time stamp counter, so
+ * measure it once.
+ */
+static void plat_tsc_measure(void)
+{
+	uint64_t mono_a, mono_b, cycles_a, cycles_b;
+	plat_tsc_sample(&mono_a, &cycles_a);
+	usleep(PLAT_TSC_MEASURE_MS * 1000);
+	plat_tsc_sample(&mono_b, &cycles_b);
+
+	plat_tsc_hz = (uint64_t) ((cycles_b - cycles_a) * 1e9
+			/ (mono_b - mono_a) + 0.5);
+}
+#endif
+
+uint64_t plat_cycles(void)
+{
+#if PLAT_TSC
+	return __rdtsc();
+#else
+	/* Read through the vDSO, so this costs no more than a system call */
+	return plat_mono_ns();
+#endif
+}
+
+uint64_t plat_cycles_per_sec(void)
+{
+#if PLAT_TSC
+	pthread_once(&plat_tsc_once, &plat_tsc_measure);
+	return plat_tsc_hz;
+#else
+	return 1000000000ULL;
+#endif
+}
+
+#if PLAT_TSC
+/*
+ * Return true if /proc/cpuinfo lists flag for the first processor.
+ */
+static int plat_cpu_flag(const char* flag)
+{
+	char line[4096];
+	int found = 0;
+	size_t len = strlen(flag);
+	FILE* info = fopen("/proc/cpuinfo", "r");
+	while (info && fgets(line, sizeof(line), info)) {
+		if (strncmp(line, "flags", 5)) continue;
+
+		char* at = line;
+		while (!found && (at = strstr(at, flag))) {
+			found = at[-1] == ' ' && (at[len] == ' ' || at[len] == '\n');
+			at += len;
+		}
+		break;
+	}
+	if (info) fclose(info);
+	return found;
+}
+#endif
+
+enum plat_cycles_rate plat_cycles_rate(void)
+{
+#if PLAT_TSC
+	/* Together: one rate through every frequency and sleep state */
+	if (plat_cpu_flag("constant_tsc") && plat_cpu_flag("nonstop_tsc")) {
+		return PLAT_CYCLES_INVARIANT;
+	}
+	return PLAT_CYCLES_PER_CPU;
+#else
+	return PLAT_CYCLES_NS;
+#endif
+}
+
+void plat_clock_resolution(long ns)
+{
+	/* High resolution timers already fire to within microseconds */
+}
+
+void plat_rt_init(void)
+{
+	/* Fault everything in now and keep it there */
+	if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+		perror(" [ mlockall ]");
+	}
+}
+
+void plat_thread_policy(pthread_t thread, int policy)
+{
+	int old;
+	struct sched_param param;
+	pthread_getschedparam(thread, &old, &param);
+
+	/* Threads coming from SCHED_OTHER have no real-time priority yet */
+	int min = sched_get_priority_min(policy);
+	if (param.sched_priority < min) param.sched_priority = min;
+	pthread_setschedparam(thread, policy, &param);
+}
+
+int plat_thread_deadline(long long runtime_ns, long long deadline_ns,
+		long long period_ns)
+{
+	struct plat_sched_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.sched_policy = SCHED_DEADLINE;
+	attr.sched_runtime = runtime_ns;
+	attr.sched_deadline = deadline_ns;
+	attr.sched_period = period_ns;
+	return (int) syscall(SYS_sched_setattr, 0, &attr, 0);
+}
+
+void plat_trace(int event, const char* what)
+{
+	pthread_once(&plat_marker_once, &plat_marker_open);
+	if (plat_marker < 0) return;
+
+	char buf[32];
+	int n = snprintf(buf, sizeof(buf), "k_log %d %s\n", event, what);
+	ssize_t rc = write(plat_marker, buf, n); /* Fails if tracing is off */
+	(void) rc;
+}
+
+int plat_cpu_count(void)
+{
+	return (int) sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+void plat_cpu_mask(pthread_t thread, unsigned mask)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	int cpu;
+	for (cpu = 0; cpu < 32; cpu++) {
+		if (mask & (1u << cpu)) CPU_SET(cpu, &set);
+	}
+	pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+
+int plat_cpu_current(void)
+{
+	return sched_getcpu();
+}
+
+/*
+ * Copy the first line of a file into buf, without its newline. Returns 0,
+ * or -1 if there's no such file.
+ */
+static int plat_read_line(const char* path, char* buf, int len)
+{
+	FILE* file = fopen(path, "r");
+	if (!file) return -1;
+
+	int rc = fgets(buf, len, file) ? 0 : -1;
+	fclose(file);
+	buf[strcspn(buf, "\n")] = '\0';
+	return rc;
+}
+
+void plat_cpu_describe(int cpu, char* buf, int len)
+{
+	char model[128] = "unknown";
+	char line[256];
+	FILE* info = fopen("/proc/cpuinfo", "r");
+	while (info && fgets(line, sizeof(line), info)) {
+		char* colon = strchr(line, ':');
+		if (strncmp(line, "model name", 10) || !colon) continue;
+
+		snprintf(model, sizeof(model), "%s", colon + 2);
+		model[strcspn(model, "\n")] = '\0';
+		break;
+	}
+	if (info) fclose(info);
+
+	/* Without cpufreq, the clock rate is out of the kernel's hands */
+	char governor[64];
+	char path[96];
+	snprintf(path, sizeof(path),
+			"/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+	if (plat_read_line(path, governor, sizeof(governor))) {
+		strcpy(governor, "fixed");
+	}
+
+	snprintf(buf, len, "%s, %s", model, governor);
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * File: plat_qnx.c
+ * Description: Host services on QNX Neutrino
+ */
+
+#if defined(__QNX__) || defined(__QNXNTO__)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/neutrino.h>
+#include <sys/syspage.h>
+#include <sys/trace.h>
+#include "plat.h"
+
+uint64_t plat_cycles(void)
+{
+	return ClockCycles();
+}
+
+uint64_t plat_cycles_per_sec(void)
+{
+	return SYSPAGE_ENTRY(qtime)->cycles_per_sec;
+}
+
+enum plat_cycles_rate plat_cycles_rate(void)
+{
+	/* Neutrino doesn't say whether ClockCycles() keeps one rate */
+	return PLAT_CYCLES_PER_CPU;
+}
+
+void plat_clock_resolution(long ns)
+{
+	struct _clockperiod clk;
+	clk.fract = 0;
+	clk.nsec = ns;
+	ClockPeriod(CLOCK_REALTIME, &clk, NULL, 0);
+}
+
+void plat_rt_init(void)
+{
+	/* I/O privileges, which ClockPeriod() needs. Memory is never paged */
+	ThreadCtl(_NTO_TCTL_IO, NULL);
+}
+
+void plat_thread_policy(pthread_t thread, int policy)
+{
+	int old;
+	struct sched_param param;
+	pthread_getschedparam(thread, &old, &param);
+	pthread_setschedparam(thread, policy, &param);
+}
+
+int plat_thread_deadline(long long runtime_ns, long long deadline_ns,
+		long long period_ns)
+{
+	/* Sporadic servers are the nearest thing, and they aren't EDF */
+	errno = ENOSYS;
+	return -1;
+}
+
+void plat_trace(int event, const char* what)
+{
+	TraceEvent(_NTO_TRACE_INSERTUSRSTREVENT, event, what);
+}
+
+int plat_cpu_count(void)
+{
+	return _syspage_ptr->num_cpu;
+}
+
+void plat_cpu_mask(pthread_t thread, unsigned mask)
+{
+	/* A pthread_t is the thread id within our process (pid 0) */
+	ThreadCtlExt(0, thread, _NTO_TCTL_RUNMASK, (void*) (uintptr_t) mask);
+}
+
+int plat_cpu_current(void)
+{
+	return SchedGetCpuNum();
+}
+
+void plat_cpu_describe(int cpu, char* buf, int len)
+{
+	if (cpu < 0 || cpu >= _syspage_ptr->num_cpu) cpu = 0;
+
+	/* Neutrino has no governors; the clock is whatever the startup set */
+	const char* model = &SYSPAGE_ENTRY(strings)->data[
+			SYSPAGE_ENTRY(cpuinfo)[cpu].name];
+	snprintf(buf, len, "%s, fixed", model);
+}
+
+#endif
@@ -7,15 +7,60 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "fixt.h"
+#include "bench/bench.h"
+#include "analyze/analyze.h"
+#include "analyze/export.h"
+#include "sweep/sweep.h"
+#include "fixt/fixt_gen.h"
 
 #include "log/kernel_trace.h"
 
 /*
  * Start up the test fixture, run the tests, then tear everything down.
+ * Passing "bench" runs the data structure micro-benchmarks instead, and
+ * "analyze" followed by trace files analyzes those. "export" followed by a
+ * trace file and a JSON file converts the trace for a trace viewer.
+ * "sweep" prints acceptance ratio curves over random task sets, taking
+ * optional tasks per set, sets per point, seed, cores and least deadline
+ * fraction, in that order.
  */
 int main(int argc, char *argv[])
 {
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		bench_run();
+		return EXIT_SUCCESS;
+	}
+	if (argc > 1 && strcmp(argv[1], "analyze") == 0) {
+		int status = EXIT_SUCCESS;
+		int i;
+		for (i = 2; i < argc; i++) {
+			if (analyze_trace(argv[i])) status = EXIT_FAILURE;
+		}
+		return status;
+	}
+	if (argc == 4 && strcmp(argv[1], "export") == 0) {
+		return export_chrome(argv[2], argv[3]) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+	if (argc > 1 && strcmp(argv[1], "sweep") == 0) {
+		struct fixt_gen_params params = { 5, 0, 10, 100, 1.0 };
+		int sets = 1000, cores = 1;
+		unsigned long long seed = 1;
+		if (argc > 2) params.gp_n = atoi(argv[2]);
+		if (argc > 3) sets = atoi(argv[3]);
+		if (argc > 4) seed = strtoull(argv[4], NULL, 0);
+		if (argc > 5) cores = atoi(argv[5]);
+		if (argc > 6) params.gp_dmin = atof(argv[6]);
+		if (params.gp_n < 1 || sets < 1 || cores < 1) return EXIT_FAILURE;
+		if (!(params.gp_dmin >= 0 && params.gp_dmin <= 1)) {
+			return EXIT_FAILURE; /* A fraction of p - c, past c */
+		}
+
+		sweep_run(&params, sets, seed, cores);
+		return EXIT_SUCCESS;
+	}
+
 	printf("Welcome to 'Experiments with Real-Time Scheduling Algorithms'\n");
 
 	fixt_init();
@@ -5,192 +5,433 @@
  * Description: CPU-time consuming functionality + timespec manipulation
  */
 
-#include <unistd.h>
 #include <time.h>
-#include <stdlib.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <stdint.h>
 #include <stdbool.h>
-#include <sys/neutrino.h>
-#include <time.h>
-#include <inttypes.h>
+#include <math.h>
 #include <pthread.h>
-#include "timing.h"
+#include "plat/plat.h"
 #include "fixt/fixt_algo.h"
 #include "spin.h"
 
 #include "log/log.h"
 
-static int FUDGE_FACTOR;
-static int FUDGE_PARTIAL;
+#define NS_PER_SEC 1000000000LL
+#define NS_PER_QUANTUM (SPIN_QUANTUM_WIDTH_MS * 1000000LL)
 
-#pragma GCC push_options
-#pragma GCC optimize ("O0")
+/* How long to watch the cycle counter against the monotonic clock */
+#define SPIN_CALIBRATE_MS 200
 
-void spin_calibrate()
+/* Longest line of the cache file, and longest key within one */
+#define SPIN_CACHE_LINE 320
+#define SPIN_CACHE_KEY (SPIN_CACHE_LINE / 2 + 32)
+
+#define SPIN_CPU_MAX 32 /* Width of a plat_cpu_mask() */
+
+/*
+ * The rate of the cycle counter as seen from one core, in the units
+ * spin_for works in. Cores may count at different rates (heterogeneous
+ * cores, counters scaled with frequency), so each has its own.
+ */
+struct spin_rate
 {
-	printf(" [ Calibrating to the host processor ]\n");
+	uint64_t sr_per_quantum; /* Cycles in a quantum */
+	uint64_t sr_gap; /* Cycles in SPIN_GAP_NS */
+};
 
-	/* Set thread to highest user priority so we reduce jitter */
-	pthread_t self = pthread_self();
-	pthread_setschedprio(self, FIXT_ALGO_BASE_PRIO);
+static struct spin_rate spin_rates[SPIN_CPU_MAX];
+static double spin_per_ns[SPIN_CPU_MAX]; /* Only touched by calibration */
+static int spin_ncpu = 1;
+static enum plat_cycles_rate spin_kind = PLAT_CYCLES_PER_CPU;
 
-	/* Set the clock period */
-	ThreadCtl(_NTO_TCTL_IO, NULL);
+static pthread_t spin_monitor_thread;
+static int spin_monitor_running;
 
-	struct _clockperiod clk;
-	clk.fract = 0;
-	clk.nsec = 100000; /* .1 ms */
-	ClockPeriod(CLOCK_REALTIME, &clk, NULL, 0);
+/*
+ * Read the monotonic clock and the cycle counter at (nearly) the same time.
+ * The counter is read between two reads of the clock, and the tightest of a
+ * few tries is kept, so neither read drifts from the other by more than a
+ * clock read or so.
+ */
+static void spin_sample(long long* mono_ns, uint64_t* cycles)
+{
+	long long best = -1;
+	int i;
+	for (i = 0; i < 8; i++) {
+		struct timespec a, b;
+		clock_gettime(CLOCK_MONOTONIC, &a);
+		uint64_t c = plat_cycles();
+		clock_gettime(CLOCK_MONOTONIC, &b);
+
+		long long a_ns = a.tv_sec * NS_PER_SEC + a.tv_nsec;
+		long long b_ns = b.tv_sec * NS_PER_SEC + b.tv_nsec;
+		if (best < 0 || b_ns - a_ns < best) {
+			best = b_ns - a_ns;
+			*mono_ns = a_ns + (b_ns - a_ns) / 2;
+			*cycles = c;
+		}
+	}
+}
+
+static long long spin_mono_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
 
-	/* Time measuring variables */
-	int64_t std_elap = 0, unit_elap = 0;
-	struct timespec init_a, post_a, elap_a;
+/*
+ * Watch the cycle counter against the monotonic clock for ms, and return
+ * the number of cycles it counts per nanosecond. Only the samples at either
+ * end matter, so being preempted in between costs no accuracy.
+ */
+static double spin_measure(int ms)
+{
+	long long mono_a, mono_b;
+	uint64_t cycles_a, cycles_b;
+	spin_sample(&mono_a, &cycles_a);
+	usleep(ms * 1000);
+	spin_sample(&mono_b, &cycles_b);
 
-	/* Measure the average accuracy of usleep */
+	return (cycles_b - cycles_a) / (double) (mono_b - mono_a);
+}
+
+/*
+ * Publish the rate of a core. Spins in progress may read the two halves
+ * from different rates, which only matters for the rest of that spin.
+ */
+static void spin_set_rate(int cpu, double per_ns)
+{
+	spin_per_ns[cpu] = per_ns;
+	__atomic_store_n(&spin_rates[cpu].sr_per_quantum,
+			(uint64_t) (per_ns * NS_PER_QUANTUM + 0.5), __ATOMIC_RELAXED);
+	__atomic_store_n(&spin_rates[cpu].sr_gap,
+			(uint64_t) (per_ns * SPIN_GAP_NS + 0.5), __ATOMIC_RELAXED);
+}
+
+/*
+ * The core the calling thread is on, as an index into the rate table.
+ */
+static int spin_cpu()
+{
+	int cpu = plat_cpu_current();
+	return cpu >= 0 && cpu < spin_ncpu ? cpu : 0;
+}
+
+/*
+ * Time a one quantum spin on the clock, up to tries times, and return the
+ * best time. A preempted spin takes longer on the clock, so stop early
+ * once a spin lands within SPIN_DRIFT_NS of the quantum.
+ */
+static long long spin_probe(int tries)
+{
+	long long best = -1;
 	int i;
-	for (i = 0; i < 10; i++)
-	{
-		/* Measure the actual time passage in a 10ms usleep */
-		clock_gettime(CLOCK_REALTIME, &init_a);
-		usleep(SPIN_QUANTUM_WIDTH_MS * 1000);
-		clock_gettime(CLOCK_REALTIME, &post_a);
-
-		/* Calculate diff */
-		timing_timespec_sub(&elap_a, &post_a, &init_a);
-		std_elap += elap_a.tv_nsec;
+	for (i = 0; i < tries; i++) {
+		long long begin = spin_mono_ns();
+		spin_for(1);
+		long long elap = spin_mono_ns() - begin;
+
+		if (best < 0 || elap < best) best = elap;
+		if (llabs(best - NS_PER_QUANTUM) <= SPIN_DRIFT_NS) break;
 	}
-	/* Compute usleep average */
-	std_elap = (int) (std_elap / 10.0);
-	int unit = 10000;
-
-	int j;
-	for (i = 0; i < 11; i++)
-	{
-		int x = 1;
-		clock_gettime(CLOCK_REALTIME, &init_a);
-
-		for (j = 0; j < unit; j++)
-		{
-			x = x + 1;
-		}
+	return best;
+}
 
-		clock_gettime(CLOCK_REALTIME, &post_a);
+/*
+ * The cache key of a core.
+ */
+static void spin_cache_key(int cpu, char* key, int len)
+{
+	char desc[SPIN_CACHE_LINE / 2];
+	plat_cpu_describe(cpu, desc, sizeof(desc));
+	snprintf(key, len, "%s, core %d", desc, cpu);
+}
 
-		if (i == 0)
-			continue;
+/*
+ * Parse a line of the cache file, a rate then a tab then the key. Returns
+ * true, with the rate, if the line is for key.
+ */
+static bool spin_cache_parse(const char* line, const char* key,
+		double* per_ns)
+{
+	const char* tab = strchr(line, '\t');
+	if (!tab) return false;
+
+	size_t n = strcspn(tab + 1, "\n");
+	if (n != strlen(key) || strncmp(tab + 1, key, n)) return false;
+
+	*per_ns = strtod(line, NULL);
+	return true;
+}
+
+/*
+ * Return the rate cached for key, or 0 if there is none.
+ */
+static double spin_cache_load(const char* key)
+{
+	FILE* file = fopen(SPIN_CACHE_FILE, "r");
+	if (!file) return 0;
 
-		timing_timespec_sub(&elap_a, &post_a, &init_a);
-		unit_elap += elap_a.tv_nsec;
+	double per_ns = 0;
+	char line[SPIN_CACHE_LINE];
+	while (fgets(line, sizeof(line), file)) {
+		if (spin_cache_parse(line, key, &per_ns)) break;
 	}
+	fclose(file);
 
-	unit_elap = (int) (unit_elap / 10.0);
-
-	/* printf("std_elap: %lld, unit_elap: %lld\n", std_elap, unit_elap); */
-	double fudge = std_elap / (double) unit_elap;
-	int fudged_unit = (int) ((double) unit * fudge);
-	int x = 1;
-	struct timespec t_init, t_post, t_elap;
-	usleep(10000);
-	long act = 0;
-
-	/* Fine tune calibration */
-	while (abs(10000000 - act) > 5000000)
-	{
-		fudged_unit *= 1.01;
-		act = 0;
-		for (j = 0; j < 10; j++)
-		{
-			clock_gettime(CLOCK_REALTIME, &t_init);
-			for (i = 0; i < fudged_unit; i++)
-			{
-				x = x + 1;
-			}
-			clock_gettime(CLOCK_REALTIME, &t_post);
-			timing_timespec_sub(&t_elap, &t_post, &t_init);
-			act += t_elap.tv_nsec;
-		}
-		act /= 10;
+	return per_ns;
+}
+
+/*
+ * Cache the rate for key, keeping the lines of other keys. The new file is
+ * written aside and renamed over the old, so runs starting at the same
+ * time never read half a file.
+ */
+static void spin_cache_store(const char* key, double per_ns)
+{
+	char path[SPIN_CACHE_LINE];
+	snprintf(path, sizeof(path), "%s.%d", SPIN_CACHE_FILE, (int) getpid());
+	FILE* out = fopen(path, "w");
+	if (!out) return;
+
+	FILE* in = fopen(SPIN_CACHE_FILE, "r");
+	char line[SPIN_CACHE_LINE];
+	double old;
+	while (in && fgets(line, sizeof(line), in)) {
+		if (!spin_cache_parse(line, key, &old)) fputs(line, out);
 	}
+	if (in) fclose(in);
 
-	usleep(1000000);
+	fprintf(out, "%.12f\t%s\n", per_ns, key);
+	if (fclose(out) || rename(path, SPIN_CACHE_FILE)) remove(path);
+}
 
-	for (j = 0; j < 10; j++)
-	{
-		clock_gettime(CLOCK_REALTIME, &t_init);
-		for (i = 0; i < fudged_unit; i++)
-		{
-			x = x + 1;
+/*
+ * Calibrate the core the calling thread is pinned to.
+ */
+static void spin_calibrate_cpu(int cpu)
+{
+	/* A rate cached by an earlier run holds unless a probe says otherwise */
+	char key[SPIN_CACHE_KEY];
+	spin_cache_key(cpu, key, sizeof(key));
+	double cached = SPIN_CACHE ? spin_cache_load(key) : 0;
+	if (cached > 0) {
+		double probe = spin_measure(SPIN_QUANTUM_WIDTH_MS);
+		if (fabs(probe - cached) * NS_PER_QUANTUM <= SPIN_DRIFT_NS) {
+			spin_set_rate(cpu, cached);
+			printf(" [ Reusing calibration of %s ]\n", key);
+			return;
 		}
-		clock_gettime(CLOCK_REALTIME, &t_post);
-		timing_timespec_sub(&t_elap, &t_post, &t_init);
-		/* printf("result: %ld\n", t_elap.tv_nsec); */
 	}
 
-	FUDGE_FACTOR = fudged_unit;
-	FUDGE_PARTIAL = FUDGE_FACTOR / 100;
+	/* Rate of the cycle counter, measured rather than taken on trust */
+	double per_ns = spin_measure(SPIN_CALIBRATE_MS);
+	spin_set_rate(cpu, per_ns);
+	if (SPIN_CACHE) spin_cache_store(key, per_ns);
 
 	/* Verify calibration */
-	printf(" [ Target 10ms ]\n");
+	printf(" [ Calibrated %s: target %lldus actual %lldus ]\n", key,
+			NS_PER_QUANTUM / 1000, spin_probe(5) / 1000);
+}
 
-	clock_gettime(CLOCK_REALTIME, &t_init);
-	spin_for(1);
-	clock_gettime(CLOCK_REALTIME, &t_post);
+/*
+ * Find the rate of the counter on every core it may differ on.
+ */
+static void spin_calibrate_rates(pthread_t self)
+{
+	/* A counter of nanoseconds, or of one fixed rate, is the same on all */
+	spin_kind = plat_cycles_rate();
+	if (spin_kind != PLAT_CYCLES_PER_CPU) {
+		spin_ncpu = 1;
+		spin_set_rate(0, spin_kind == PLAT_CYCLES_NS ? 1.0
+				: plat_cycles_per_sec() / (double) NS_PER_SEC);
+		printf(" [ %s: target %lldus actual %lldus ]\n",
+				spin_kind == PLAT_CYCLES_NS ? "Counter is the monotonic clock"
+						: "Counter runs at one rate on every core",
+				NS_PER_QUANTUM / 1000, spin_probe(5) / 1000);
+		return;
+	}
 
-	timing_timespec_sub(&t_elap, &t_post, &t_init);
-	printf(" [ Actual %ldms ]\n", t_elap.tv_nsec / 1000000);
-//	printf(" [ FudgeF %d ]\n", FUDGE_FACTOR);
-//	printf(" [ FudgeP %d ]\n", FUDGE_PARTIAL);
-//	printf(" [ Calibration successful! ]\n");
+	/* Visit every core in turn, to read the counter as it sees it */
+	int n = plat_cpu_count();
+	spin_ncpu = n < SPIN_CPU_MAX ? n : SPIN_CPU_MAX;
+	int cpu;
+	for (cpu = 0; cpu < spin_ncpu; cpu++) {
+		plat_cpu_mask(self, 1u << cpu);
+		spin_calibrate_cpu(cpu);
+	}
+	plat_cpu_mask(self, spin_ncpu < 32 ? (1u << spin_ncpu) - 1 : ~0u);
 }
-#pragma GCC pop_options
 
-#pragma GCC push_options
-#pragma GCC optimize ("O0")
-void spin_for(int quanta)
+void spin_calibrate()
 {
-	int i, x = 0;
-	for (i = 0; i < (quanta * FUDGE_FACTOR); i++)
-	{
-		x = x + 1;
+	printf(" [ Calibrating to the host processor ]\n");
+
+	/*
+	 * Set thread to highest user priority so we reduce jitter. Policy and
+	 * priority go together: Linux won't raise the priority of a
+	 * SCHED_OTHER thread on its own
+	 */
+	pthread_t self = pthread_self();
+	int policy;
+	struct sched_param old, param;
+	pthread_getschedparam(self, &policy, &old);
+	param.sched_priority = FIXT_ALGO_BASE_PRIO;
+	int err = pthread_setschedparam(self, SCHED_FIFO, &param);
+	if (err) {
+		fprintf(stderr, " [ spin ] calibrating at priority %d: %s\n",
+				FIXT_ALGO_BASE_PRIO, strerror(err));
 	}
+
+	/* Set the clock period */
+	plat_clock_resolution(100000); /* .1 ms */
+
+	spin_calibrate_rates(self);
+	pthread_setschedparam(self, policy, &old);
 }
-#pragma GCC pop_options
 
-#pragma GCC push_options
-#pragma GCC optimize ("O0")
-void spin_for_nmt(int quanta)
+/*
+ * Every SPIN_MONITOR_MS, visit each core and check its rate against the
+ * clock, recalibrating any which has drifted. The check only sleeps
+ * between two samples, so it costs the schedule under test next to nothing.
+ */
+static void* spin_monitor_main(void* arg)
 {
-	struct timespec init, post, elap;
-	clock_gettime(CLOCK_REALTIME, &init);
+	struct timespec period = { SPIN_MONITOR_MS / 1000,
+			(SPIN_MONITOR_MS % 1000) * 1000000L };
+	pthread_t self = pthread_self();
+	while (__atomic_load_n(&spin_monitor_running, __ATOMIC_ACQUIRE)) {
+		nanosleep(&period, NULL);
+
+		int cpu;
+		for (cpu = 0; cpu < spin_ncpu; cpu++) {
+			plat_cpu_mask(self, 1u << cpu);
+			double probe = spin_measure(SPIN_QUANTUM_WIDTH_MS);
+			double drift = (probe - spin_per_ns[cpu]) * NS_PER_QUANTUM;
+			if (fabs(drift) <= SPIN_DRIFT_NS) continue;
+
+			printf(" [ Core %d drifted %+.0fus a quantum; recalibrating ]\n",
+					cpu, drift / 1000.0);
+			spin_set_rate(cpu, probe);
+			if (SPIN_CACHE) {
+				char key[SPIN_CACHE_KEY];
+				spin_cache_key(cpu, key, sizeof(key));
+				spin_cache_store(key, probe);
+			}
+		}
+	}
+	return NULL;
+}
+
+void spin_monitor_start()
+{
+	if (SPIN_MONITOR_MS <= 0) return;
+	if (spin_kind != PLAT_CYCLES_PER_CPU) return; /* Nothing to drift */
+	if (__atomic_exchange_n(&spin_monitor_running, 1, __ATOMIC_ACQ_REL)) {
+		return; /* Already monitoring */
+	}
 
-	const long target = quanta * SPIN_QUANTUM_WIDTH_MS * 1000000;
+	/* Below even the trace drain: it only needs a moment now and then */
+	pthread_attr_t attr;
+	struct sched_param param;
+	pthread_attr_init(&attr);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	param.sched_priority = SPIN_MONITOR_PRIO;
+	pthread_attr_setschedparam(&attr, &param);
+
+	if (pthread_create(&spin_monitor_thread, &attr, &spin_monitor_main,
+			NULL)) {
+		__atomic_store_n(&spin_monitor_running, 0, __ATOMIC_RELEASE);
+	}
+	pthread_attr_destroy(&attr);
+}
 
-	int i = 0;
-	int x = 0;
-	while(true) {
-		if(i++ % FUDGE_PARTIAL == 0) {
-			clock_gettime(CLOCK_REALTIME, &post);
-			timing_timespec_sub(&elap, &post, &init);
-			if(elap.tv_nsec > target) {
-				break;
-			}
+void spin_monitor_stop()
+{
+	if (__atomic_exchange_n(&spin_monitor_running, 0, __ATOMIC_ACQ_REL)) {
+		pthread_join(spin_monitor_thread, NULL);
+	}
+}
+
+void spin_for(int quanta)
+{
+	spin_for_with(quanta, NULL, NULL);
+}
+
+void spin_for_with(int quanta, void (*chunk)(void*), void* arg)
+{
+	if (quanta <= 0) return;
+
+	int cpu = spin_cpu();
+	struct spin_rate* rate = &spin_rates[cpu];
+	uint64_t left = (uint64_t) quanta
+			* __atomic_load_n(&rate->sr_per_quantum, __ATOMIC_RELAXED);
+	uint64_t gap = __atomic_load_n(&rate->sr_gap, __ATOMIC_RELAXED);
+
+	/*
+	 * Count down the cycles which pass while this thread is on the
+	 * processor. Stretches between reads longer than the gap were spent
+	 * preempted and count for nothing, so a job spins for its full
+	 * execution time however often it is interrupted.
+	 */
+	uint64_t last = plat_cycles();
+	while (left) {
+		if (chunk) chunk(arg);
+		uint64_t now = plat_cycles();
+		uint64_t step = now - last;
+		last = now;
+
+		if (step <= gap) {
+			left = step < left ? left - step : 0;
+			continue;
 		}
-		x = x + 1;
+
+		/* Only a preempted thread can have moved to another core */
+		int moved = spin_cpu();
+		if (moved == cpu) continue;
+
+		struct spin_rate* to = &spin_rates[moved];
+		uint64_t per = __atomic_load_n(&rate->sr_per_quantum,
+				__ATOMIC_RELAXED);
+		uint64_t to_per = __atomic_load_n(&to->sr_per_quantum,
+				__ATOMIC_RELAXED);
+		left = (uint64_t) ((double) left * to_per / per);
+		gap = __atomic_load_n(&to->sr_gap, __ATOMIC_RELAXED);
+		cpu = moved;
+		rate = to;
+		last = plat_cycles(); /* Counters of two cores needn't agree */
+	}
+}
+
+void spin_for_nmt(int quanta)
+{
+	if (quanta <= 0) return;
+
+	/* Preempted or not, stop once the quanta have passed on the clock */
+	uint64_t per = __atomic_load_n(&spin_rates[spin_cpu()].sr_per_quantum,
+			__ATOMIC_RELAXED);
+	uint64_t end = plat_cycles() + (uint64_t) quanta * per;
+	while ((int64_t) (plat_cycles() - end) < 0) {
 	}
 }
-#pragma GCC pop_options
 
 struct timespec spin_abstime_in_quanta(int quanta, long jitter_ns)
 {
 	struct timespec abs_next;
 	clock_gettime(CLOCK_REALTIME, &abs_next);
 
-	abs_next.tv_nsec += (SPIN_QUANTUM_WIDTH_MS * quanta * 1000000) + jitter_ns;
-	long remainder = abs_next.tv_nsec - 1000000000;
-	if(remainder > 0) {
-		abs_next.tv_nsec = remainder;
-		abs_next.tv_sec += 1;
+	long long nsec = abs_next.tv_nsec + quanta * NS_PER_QUANTUM + jitter_ns;
+	abs_next.tv_sec += nsec / NS_PER_SEC;
+	abs_next.tv_nsec = nsec % NS_PER_SEC;
+	if (abs_next.tv_nsec < 0) {
+		abs_next.tv_nsec += NS_PER_SEC;
+		abs_next.tv_sec -= 1;
 	}
 
 	return abs_next;
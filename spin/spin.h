@@ -16,18 +16,63 @@
 #define SPIN_QUANTUM_WIDTH_MS 10
 
 /*
- * Calibrate the spin module for the hardware in use.
+ * Two reads of the cycle counter further apart than this can't both have
+ * come from the spin loop: the thread was preempted in between, and the
+ * time it spent off the processor isn't CPU time consumed.
+ */
+#define SPIN_GAP_NS 10000
+
+/*
+ * With SPIN_CACHE set, calibrations are kept between runs in SPIN_CACHE_FILE,
+ * one line per processor model, frequency governor and core. A run which
+ * finds its line only checks the rate with a one quantum probe, and
+ * calibrates afresh if it has drifted by more than SPIN_DRIFT_NS a quantum.
+ */
+#define SPIN_CACHE 1
+#define SPIN_CACHE_FILE "/tmp/qnx-scheduling.spin"
+#define SPIN_DRIFT_NS 20000
+
+/*
+ * With SPIN_MONITOR_MS above 0, spin_monitor_start() starts a thread which
+ * checks the rate of every core that often, and recalibrates cores which
+ * have drifted (as a governor or thermal limit changes their clock). Only
+ * counters whose rate may differ between cores are monitored.
+ */
+#define SPIN_MONITOR_MS 1000
+#define SPIN_MONITOR_PRIO 5
+
+/*
+ * Calibrate the spin module for the hardware in use: measure the rate of
+ * the cycle counter against the monotonic clock on each core, or reuse the
+ * rate cached by an earlier run. Counters which plat reports as the clock
+ * itself, or as one rate on every core, take that rate as it is.
  */
 void spin_calibrate();
 
 /*
- * Consume CPU time for a particular number of quanta.
+ * Start and stop the drift monitor.
+ */
+void spin_monitor_start();
+void spin_monitor_stop();
+
+/*
+ * Consume CPU time for a particular number of quanta, to within a few
+ * microseconds, at the rate of whichever core the thread is on. Time spent
+ * preempted doesn't count toward it.
  */
 void spin_for(int quanta);
 
+/*
+ * Consume CPU time as spin_for() does, calling chunk(arg) over and over
+ * for the duration. Each call must take well under SPIN_GAP_NS, or it is
+ * mistaken for time spent preempted.
+ */
+void spin_for_with(int quanta, void (*chunk)(void*), void* arg);
+
 /*
  * Consume CPU time for a particular number of quanta, but for not more
- * than that specific number of quanta.
+ * than that specific number of quanta: the spin ends that long after it
+ * began, however much of it the thread spent preempted.
  */
 void spin_for_nmt(int quanta);
 
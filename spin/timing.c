@@ -10,7 +10,6 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <time.h>
-#include <sys/neutrino.h>
 
 #include "timing.h"
 
@@ -104,7 +103,7 @@ void timing_heartbeat_wait(struct timespec *init, long nanos)
 		//printf("timing_elap: %d, %ld\r\n", elap.tv_sec, elap.tv_nsec);
 		if(timing_timespec_sub(&elap, &durt, &elap) == 0) {
 			//printf("clock_nanosleep: %ld\r\n", elap.tv_nsec);
-			clock_nanosleep(CLOCK_REALTIME, NULL, &elap, NULL);
+			clock_nanosleep(CLOCK_REALTIME, 0, &elap, NULL);
 		}
 	} else {
 		//printf("else: %d, %ld\r\n", elap.tv_sec, elap.tv_nsec);
@@ -0,0 +1,178 @@
+/*
+ * File: workload.c
+ * Description: Synthetic task bodies which consume CPU time in chunks
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "spin.h"
+#include "workload.h"
+
+#define LINE_WORDS 8 /* 64 byte cache lines */
+
+/*
+ * Chunk sizes. Each chunk has to stay well below SPIN_GAP_NS even when every
+ * access misses, or spin_for_with() takes it for time spent preempted.
+ */
+#define STREAM_LINES 64 /* 4KB, under a microsecond even from memory */
+#define CHASE_HOPS 16 /* A few microseconds at worst */
+#define SIMD_ROUNDS 64
+
+/*
+ * Eight floats, which GCC maps onto an AVX register with -mavx2 (or onto
+ * two SSE or NEON registers without).
+ */
+typedef float spin_v8sf __attribute__ ((vector_size (32)));
+
+static const char* spin_work_names[SPIN_WORK_KINDS] = {
+	"spin", "stream", "chase", "simd", "mixed"
+};
+
+void spin_work_init(struct spin_work* work, enum spin_work_kind kind,
+		size_t bytes)
+{
+	memset(work, 0, sizeof(*work));
+	work->sw_kind = kind;
+	work->sw_bytes = bytes ? bytes : SPIN_WORK_BYTES;
+}
+
+/*
+ * Link every cache line of the chase half into a single random cycle, so
+ * that the hardware prefetchers can't guess the next line. The cycle comes
+ * out the same every run.
+ */
+static void spin_work_link(struct spin_work* work)
+{
+	uint64_t* chase = work->sw_buf + work->sw_words;
+	size_t lines = work->sw_words / LINE_WORDS;
+	size_t* order = malloc(lines * sizeof(*order));
+	size_t i;
+	for (i = 0; i < lines; i++) {
+		order[i] = i;
+	}
+
+	/* Sattolo's shuffle, which always leaves one cycle through them all */
+	unsigned seed = 1;
+	for (i = lines - 1; i > 0; i--) {
+		size_t j = rand_r(&seed) % i;
+		size_t t = order[i];
+		order[i] = order[j];
+		order[j] = t;
+	}
+	for (i = 0; i < lines; i++) {
+		chase[order[i] * LINE_WORDS] = order[(i + 1) % lines] * LINE_WORDS;
+	}
+
+	free(order);
+}
+
+void spin_work_alloc(struct spin_work* work)
+{
+	if (work->sw_kind == SPIN_WORK_SPIN || work->sw_kind == SPIN_WORK_SIMD) {
+		return; /* Registers only */
+	}
+
+	/* Stream over one half of the working set and chase through the other */
+	size_t lines = work->sw_bytes / (2 * LINE_WORDS * sizeof(uint64_t));
+	if (lines < STREAM_LINES) lines = STREAM_LINES;
+	work->sw_words = lines * LINE_WORDS;
+	work->sw_buf = calloc(2 * work->sw_words, sizeof(uint64_t));
+	spin_work_link(work);
+
+	work->sw_pos = 0;
+	work->sw_node = 0;
+}
+
+void spin_work_free(struct spin_work* work)
+{
+	free(work->sw_buf);
+	work->sw_buf = NULL;
+}
+
+static void spin_work_stream(struct spin_work* work)
+{
+	uint64_t* a = work->sw_buf;
+	uint64_t sum = 0;
+	int i;
+	for (i = 0; i < STREAM_LINES * LINE_WORDS; i++) {
+		sum += a[work->sw_pos + i]++;
+	}
+	work->sw_pos += STREAM_LINES * LINE_WORDS;
+	if (work->sw_pos + STREAM_LINES * LINE_WORDS > work->sw_words) {
+		work->sw_pos = 0;
+	}
+	work->sw_sink += sum;
+}
+
+static void spin_work_chase(struct spin_work* work)
+{
+	const uint64_t* chase = work->sw_buf + work->sw_words;
+	size_t node = work->sw_node;
+	int i;
+	for (i = 0; i < CHASE_HOPS; i++) {
+		node = chase[node];
+	}
+	work->sw_node = node;
+}
+
+static void spin_work_simd(struct spin_work* work)
+{
+	/* Four independent chains, to keep more than one vector unit busy */
+	spin_v8sf a = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	spin_v8sf b = a * 0.5f, c = a * 0.25f, d = a * 0.125f;
+	const spin_v8sf m = { 0.999f, 0.999f, 0.999f, 0.999f,
+			0.999f, 0.999f, 0.999f, 0.999f };
+	const spin_v8sf k = { 0.001f, 0.001f, 0.001f, 0.001f,
+			0.001f, 0.001f, 0.001f, 0.001f };
+	int i;
+	for (i = 0; i < SIMD_ROUNDS; i++) {
+		a = a * m + k;
+		b = b * m + k;
+		c = c * m + k;
+		d = d * m + k;
+	}
+
+	spin_v8sf s = a + b + c + d;
+	work->sw_sink += (uint64_t) (s[0] + s[7]);
+}
+
+/*
+ * One chunk of the kernel, passed to spin_for_with().
+ */
+static void spin_work_chunk(void* arg)
+{
+	struct spin_work* work = (struct spin_work*) arg;
+	enum spin_work_kind kind = work->sw_kind;
+	if (kind == SPIN_WORK_MIXED) {
+		kind = SPIN_WORK_STREAM + work->sw_turn;
+		work->sw_turn = (work->sw_turn + 1) % 3;
+	}
+
+	switch (kind) {
+	case SPIN_WORK_STREAM:
+		spin_work_stream(work);
+		break;
+	case SPIN_WORK_CHASE:
+		spin_work_chase(work);
+		break;
+	case SPIN_WORK_SIMD:
+		spin_work_simd(work);
+		break;
+	default:
+		break;
+	}
+}
+
+void spin_work_for(struct spin_work* work, int quanta)
+{
+	if (work->sw_kind == SPIN_WORK_SPIN) {
+		spin_for(quanta);
+	} else {
+		spin_for_with(quanta, &spin_work_chunk, work);
+	}
+}
+
+const char* spin_work_name(enum spin_work_kind kind)
+{
+	return kind < SPIN_WORK_KINDS ? spin_work_names[kind] : "?";
+}
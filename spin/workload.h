@@ -0,0 +1,69 @@
+/*
+ * File: workload.h
+ * Description: Synthetic task bodies which consume CPU time in chunks
+ */
+
+#ifndef WORKLOAD_H_
+#define WORKLOAD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * What a job does with its execution time. SPIN_WORK_SPIN touches nothing
+ * but registers, as spin_for() does; the rest touch memory and so feel the
+ * cache left behind by whichever job ran last.
+ */
+enum spin_work_kind
+{
+	SPIN_WORK_SPIN, /* Registers only */
+	SPIN_WORK_STREAM, /* Sweep an array, bound by memory bandwidth */
+	SPIN_WORK_CHASE, /* Follow a random cycle of pointers, bound by latency */
+	SPIN_WORK_SIMD, /* Vector arithmetic on registers */
+	SPIN_WORK_MIXED, /* Each of the above in turn */
+	SPIN_WORK_KINDS
+};
+
+/*
+ * Working set of the kernels which touch memory, unless told otherwise.
+ */
+#define SPIN_WORK_BYTES (4 << 20)
+
+/*
+ * A kernel and its working set. The buffer is allocated by
+ * spin_work_alloc(), outside of any job, and freed by spin_work_free().
+ */
+struct spin_work
+{
+	enum spin_work_kind sw_kind;
+	size_t sw_bytes; /* Working set asked for */
+
+	uint64_t* sw_buf; /* The array swept, then the cycle chased */
+	size_t sw_words; /* Words in each half of the buffer */
+	size_t sw_pos; /* Where the sweep left off */
+	size_t sw_node; /* Where the chase left off */
+	int sw_turn; /* Kernel whose turn it is under SPIN_WORK_MIXED */
+	uint64_t sw_sink; /* Results, kept so no kernel is optimized away */
+};
+
+/*
+ * Choose a kernel and working set (0 for SPIN_WORK_BYTES). Allocates
+ * nothing yet.
+ */
+void spin_work_init(struct spin_work*, enum spin_work_kind, size_t bytes);
+
+/*
+ * Allocate and lay out the working set, and free it again.
+ */
+void spin_work_alloc(struct spin_work*);
+void spin_work_free(struct spin_work*);
+
+/*
+ * Consume CPU time for a particular number of quanta running the kernel,
+ * as precisely as spin_for().
+ */
+void spin_work_for(struct spin_work*, int quanta);
+
+const char* spin_work_name(enum spin_work_kind);
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * File: sweep.c
+ * Description: Acceptance ratio sweeps over random task sets
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "fixt/fixt_algo.h"
+#include "fixt/fixt_set.h"
+#include "fixt/fixt_gen.h"
+#include "fixt/fixt_analysis.h"
+#include "fixt/fixt_partition.h"
+#include "fixt/impl/rma/fixt_algo_impl_rma.h"
+#include "fixt/impl/edf/fixt_algo_impl_edf.h"
+#include "fixt/impl/sct/fixt_algo_impl_sct.h"
+#include "sweep.h"
+
+#include "log/kernel_trace.h"
+
+#define SWEEP_ALGOS 3
+
+/* The algo sweep_simulate() judges by, as AlgoVerdict takes only a set */
+static struct fixt_algo* sweep_sim_algo;
+
+static long long sweep_gcd(long long a, long long b)
+{
+	while (b) {
+		long long t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/*
+ * Quanta after which a synchronous release of the set repeats, capped at
+ * SWEEP_SIM_QUANTA.
+ */
+static int sweep_horizon(struct fixt_set* set)
+{
+	long long h = 1;
+	int i;
+	for (i = 0; i < set->ts_count && h < SWEEP_SIM_QUANTA; i++) {
+		int p = set->ts_tasks[i].tk_p;
+		h = h / sweep_gcd(h, p) * p;
+	}
+	return h < SWEEP_SIM_QUANTA ? (int) h : SWEEP_SIM_QUANTA;
+}
+
+/*
+ * Judge a set by running it on a simulated clone of sweep_sim_algo.
+ */
+static enum fixt_verdict sweep_simulate(struct fixt_set* set)
+{
+	/*
+	 * Only the verdict matters, so the run logs into a trace of its own,
+	 * deleted with it, rather than piling every set's events up in one
+	 */
+	struct k_log_csv* outer = k_log_csv_current();
+	struct k_log_csv* trace = k_log_csv_new();
+	k_log_csv_bind(trace);
+
+	struct fixt_algo* algo = fixt_algo_clone(sweep_sim_algo);
+	fixt_algo_load(algo, set);
+	fixt_algo_simulate(algo, true);
+	fixt_algo_init(algo);
+
+	int horizon = sweep_horizon(set);
+	while (algo->al_now < horizon && algo->al_schedulable) {
+		fixt_algo_step(algo);
+	}
+	bool pass = algo->al_schedulable;
+
+	fixt_algo_halt(algo);
+	fixt_algo_del(algo);
+
+	k_log_csv_bind(outer);
+	k_log_csv_del(trace);
+	return pass ? FIXT_VERDICT_PASS : FIXT_VERDICT_FAIL;
+}
+
+/*
+ * Whether an algo accepts a set on the given number of cores.
+ */
+static bool sweep_accepts(struct fixt_algo* algo, struct fixt_set* set,
+		int cores)
+{
+	AlgoVerdict judge = algo->al_analyze;
+	if (!judge) {
+		sweep_sim_algo = algo;
+		judge = &sweep_simulate;
+	}
+
+	if (cores == 1) return judge(set) == FIXT_VERDICT_PASS;
+
+	struct fixt_set** part = fixt_partition(set, cores,
+			FIXT_PARTITION_FIRST_FIT, judge);
+	if (!part) return false;
+	fixt_partition_del(part, cores);
+	return true;
+}
+
+/*
+ * The point a set belongs to: the first at or above its utilization.
+ */
+static int sweep_point(struct fixt_set* set)
+{
+	double u = fixt_analysis_utilization(set);
+	return (int) ceil(u / SWEEP_U_STEP - 1e-6);
+}
+
+void sweep_run(struct fixt_gen_params* params, int sets, uint64_t seed,
+		int cores)
+{
+	struct fixt_algo* algos[SWEEP_ALGOS] = {
+		fixt_algo_impl_rma_new(),
+		fixt_algo_impl_edf_new(),
+		fixt_algo_impl_sct_new()
+	};
+
+	printf(" [ Acceptance ratio: %d tasks, periods %d-%d, deadlines from "
+			"%.2f, %d sets a point, seed %llu, %d core(s) ]\n",
+			params->gp_n, params->gp_pmin, params->gp_pmax, params->gp_dmin,
+			sets, (unsigned long long) seed, cores);
+	printf(" %8s", "u");
+	int a;
+	for (a = 0; a < SWEEP_ALGOS; a++) {
+		printf(" %8s", algos[a]->al_name);
+	}
+	printf(" %8s\n", "sets");
+
+	struct fixt_gen gen;
+	fixt_gen_seed(&gen, seed);
+
+	/*
+	 * Rounding c to whole quanta moves a set off the utilization it was
+	 * drawn for, so it counts toward the point its actual utilization
+	 * falls under. Sets past the last point count for none.
+	 */
+	int points = (int) (cores / SWEEP_U_STEP + 0.5);
+	int (*accepted)[SWEEP_ALGOS] = calloc(points + 1, sizeof(*accepted));
+	int* made = calloc(points + 1, sizeof(*made));
+	int k;
+	for (k = 1; k <= points; k++) {
+		params->gp_u = k * SWEEP_U_STEP;
+
+		int s;
+		for (s = 0; s < sets; s++) {
+			struct fixt_set* set = fixt_gen_set(&gen, k, params);
+			if (!set) continue; /* UUniFast-Discard gave up */
+
+			int at = sweep_point(set);
+			if (at >= 1 && at <= points) {
+				made[at]++;
+				for (a = 0; a < SWEEP_ALGOS; a++) {
+					if (sweep_accepts(algos[a], set, cores)) {
+						accepted[at][a]++;
+					}
+				}
+			}
+			fixt_set_del(set);
+		}
+	}
+
+	for (k = 1; k <= points; k++) {
+		printf(" %8.2f", k * SWEEP_U_STEP);
+		for (a = 0; a < SWEEP_ALGOS; a++) {
+			if (made[k]) {
+				printf(" %8.3f", accepted[k][a] / (double) made[k]);
+			} else {
+				printf(" %8s", "-"); /* No set came out this light */
+			}
+		}
+		printf(" %8d\n", made[k]);
+	}
+	free(accepted);
+	free(made);
+
+	for (a = 0; a < SWEEP_ALGOS; a++) {
+		fixt_algo_del(algos[a]);
+	}
+}
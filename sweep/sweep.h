@@ -0,0 +1,31 @@
+/*
+ * File: sweep.h
+ * Description: Acceptance ratio sweeps over random task sets
+ */
+
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include <stdint.h>
+
+struct fixt_gen_params;
+
+#define SWEEP_U_STEP 0.05 /* Utilization between points, per core */
+#define SWEEP_SIM_QUANTA 2000 /* Longest simulation of a set, in quanta */
+
+/*
+ * Generate sets random task sets (fixt_gen) at each utilization from
+ * SWEEP_U_STEP up to cores, and print the fraction of them each algorithm
+ * accepts, one row per utilization: a curve per algorithm. A set counts
+ * toward the row its actual utilization, once c is rounded to whole
+ * quanta, falls in: above the row before, up to its own. Every algorithm
+ * judges the same sets. An algorithm with an al_analyze is judged by it,
+ * any other by simulating the set over its hyperperiod (at most
+ * SWEEP_SIM_QUANTA). Above one core, a set is accepted if First-Fit
+ * Decreasing can partition it with the same judge admitting each core.
+ * params->gp_u is ignored.
+ */
+void sweep_run(struct fixt_gen_params* params, int sets, uint64_t seed,
+		int cores);
+
+#endif